@@ -0,0 +1,57 @@
+#ifndef bench_SyntheticCorpus_hh
+#define bench_SyntheticCorpus_hh
+//
+// Generator of synthetic .ccl geometry files for benchmarking.
+//
+// Every file describes one building volume: a star-shaped polygon of
+// CorpusSpec::vertices vertices around a centre on a square grid, so
+// that the volumes of a corpus do not overlap and stay inside the
+// default world.  The shape of the input is controlled by
+//
+//   depth           - length of the reference chains: a vertex is
+//                     given relative to the previous vertex, except
+//                     every depth-th one, which is given relative to
+//                     the origin "*" (depth 1 means no chaining)
+//   rotationDensity - fraction of the chains given in a rotated frame
+//                     (one of the rotations used in geom/)
+//   boundaryPoints  - number of world-wall points per file, spread over
+//                     the northern half of the polygon ("[W]" at its
+//                     west end, "[E]" at its east end, "[N]" between),
+//                     whose vertices are then outline (lower case)
+//                     vertices so that a dirt volume is inferred; the
+//                     northern half lies on an arc, which keeps the
+//                     dirt polygon simple
+//
+// The output is a deterministic function of the spec, including seed.
+// Coordinates are written in ft:in with three decimals of an inch,
+// like the hand-written files; the relative coordinates are computed
+// from the rounded positions of their references, so that rounding
+// does not accumulate along the chains.
+//
+
+// C++ includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+  struct CorpusSpec {
+    unsigned      files           = 99;
+    unsigned      vertices        = 20;
+    unsigned      depth           = 4;
+    double        rotationDensity = 0.1;
+    unsigned      boundaryPoints  = 4;
+    std::uint64_t seed            = 1;
+  };
+
+  // Contents of the .ccl file with the given index
+  std::string syntheticVolume( const CorpusSpec& spec, unsigned fileIndex );
+
+  // Writes all files of the corpus to dir (which must exist) and
+  // returns their names
+  std::vector<std::string> writeCorpus( const CorpusSpec& spec, const std::string& dir );
+
+} // end of namespace bench
+
+#endif /* bench_SyntheticCorpus_hh */
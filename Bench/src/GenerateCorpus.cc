@@ -0,0 +1,50 @@
+// C++ includes
+#include <iostream>
+#include <stdexcept>
+#include <sys/stat.h>
+
+// BOOST options - silence unused local typedefs warnings
+#pragma GCC diagnostic ignored "-Wunused-local-typedefs"
+#include "boost/program_options.hpp"
+
+// Bench
+#include "Bench/inc/SyntheticCorpus.hh"
+
+using namespace std;
+namespace po = boost::program_options;
+
+//=================================================
+int main(int argc, char* argv[]) {
+
+  bench::CorpusSpec spec;
+  string dir;
+
+  po::options_description desc("Allowed options");
+  desc.add_options()
+    ("help", "produce help message")
+    ("output", po::value<string>(&dir)->default_value("corpus"), "directory the .ccl files are written to")
+    ("files", po::value<unsigned>(&spec.files)->default_value(spec.files), "number of files")
+    ("vertices", po::value<unsigned>(&spec.vertices)->default_value(spec.vertices), "vertices per file")
+    ("depth", po::value<unsigned>(&spec.depth)->default_value(spec.depth), "length of the reference chains")
+    ("rotations", po::value<double>(&spec.rotationDensity)->default_value(spec.rotationDensity), "fraction of chains in a rotated frame")
+    ("boundaries", po::value<unsigned>(&spec.boundaryPoints)->default_value(spec.boundaryPoints), "[N/E/W] world-wall points per file")
+    ("seed", po::value<std::uint64_t>(&spec.seed)->default_value(spec.seed), "random seed")
+    ;
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) { cout << desc << "\n"; return 1; }
+
+  try {
+    ::mkdir( dir.c_str(), 0777 );
+    const auto names = bench::writeCorpus( spec, dir );
+    cout << " Wrote " << names.size() << " files with " << spec.vertices << " vertices each to " << dir << endl;
+  }
+  catch ( const std::exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+}
@@ -0,0 +1,359 @@
+// Benchmarks of the stages of ProduceSimpleConfig on synthetic corpora.
+//
+// For every corpus size ("FILESxVERTICES") a corpus is generated in
+// <workdir>/FILESxVERTICES/geom and the following are timed, each as
+// the best of --repeat runs over the whole corpus:
+//
+//   parse        - Coordinate construction from every coordinate line
+//                  (lines already in memory)
+//   collection   - CoordinateCollection construction: reading the file,
+//                  parsing, check_and_push_back (label and reference
+//                  resolution) and the position calculation
+//   boundaries   - addWorldBoundaries on every collection
+//   write        - printSimpleConfigFile into an empty output directory
+//   unchanged    - printSimpleConfigFile when the files are up to date
+//   classify     - VolumeLocator::classify of random points in the
+//                  extent of the volumes, with --jobs threads (rates
+//                  are per point; building the locator is not timed)
+//   runJob       - the ProduceSimpleConfig executable with --force 1
+//                  (skipped if --executable does not exist)
+//   runJob (inc) - the same without --force, i.e. nothing to regenerate
+//
+// Then, unless --table 0, a table of --table rows of a key and four
+// numbers is generated in <workdir>/table.txt and loaded with
+//
+//   loadTable        - loadTable<5>
+//   columnar         - loadColumnarTable<5> on one thread
+//   columnar (jobs)  - the same on --jobs threads (if more than one)
+//   columnar (cache) - the same from its binary cache
+//
+// after checking that the columnar table, parsed and cached, has the
+// rows of loadTable<5>.
+
+// C++ includes
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+// BOOST options - silence unused local typedefs warnings
+#pragma GCC diagnostic ignored "-Wunused-local-typedefs"
+#include "boost/program_options.hpp"
+
+// Utilities
+#include "Utilities/inc/ColumnarTable.hh"
+#include "Utilities/inc/Config.hh"
+#include "Utilities/inc/Coordinate.hh"
+#include "Utilities/inc/CoordinateCollection.hh"
+#include "Utilities/inc/MappedFile.hh"
+#include "Utilities/inc/OutputFile.hh"
+#include "Utilities/inc/PolygonCheck.hh"
+#include "Utilities/inc/VolumeLocator.hh"
+
+// Bench
+#include "Bench/inc/SyntheticCorpus.hh"
+
+using namespace std;
+using namespace util;
+namespace po = boost::program_options;
+
+namespace {
+
+  unsigned repeat_    = 5;
+  unsigned jobs_      = 1;
+  size_t   tableRows_ = 2000000;
+  string   executable_;
+
+  const map<worldDir::enum_type,Coordinate::Rep<double>> worldCorners =
+    {{
+        {worldDir::NW,{-50000, 50000}},
+        {worldDir::NE,{ 50000, 50000}},
+        {worldDir::SE,{ 50000,-50000}},
+        {worldDir::SW,{-50000,-50000}}
+      }};
+
+  // Keeps the compiler from discarding the benchmarked work
+  volatile double sink_;
+
+  // Best wall-clock time (s) of repeat_ calls of f; setup, if given, is
+  // called untimed before each of them
+  template <typename F, typename S>
+  double timeBest( F&& f, S&& setup ) {
+    double best = numeric_limits<double>::max();
+    for ( unsigned rep(0) ; rep < repeat_ ; ++rep ) {
+      setup();
+      const auto start = chrono::steady_clock::now();
+      f();
+      const chrono::duration<double> elapsed = chrono::steady_clock::now()-start;
+      best = min( best, elapsed.count() );
+    }
+    return best;
+  }
+
+  template <typename F>
+  double timeBest( F&& f ) { return timeBest( f, []{} ); }
+
+  void report( const string& name, double seconds, size_t nItems, const string& unit = "vertex" ) {
+    cout << "  " << left << setw(16) << name << right << fixed
+         << setw(10) << setprecision(3) << seconds*1e3 << " ms"
+         << setw(10) << setprecision(1) << seconds*1e9/nItems << " ns/" << unit
+         << setw(10) << setprecision(2) << nItems/seconds*1e-6 << " M" << unit << "/s"
+         << endl;
+  }
+
+  void runCorpus( const bench::CorpusSpec& spec, const string& workdir );
+  void checkCorpus( const vector<CoordinateCollection>& collections );
+  void runTable( const string& workdir );
+
+}
+
+//=================================================
+int main(int argc, char* argv[]) {
+
+  bench::CorpusSpec spec;
+  string workdir;
+  vector<string> sizes;
+
+  po::options_description desc("Allowed options");
+  desc.add_options()
+    ("help", "produce help message")
+    ("corpus", po::value<vector<string>>(&sizes)->multitoken(), "corpus sizes as FILESxVERTICES [default is 99x20 99x100 100x1000 1000x100]")
+    ("depth", po::value<unsigned>(&spec.depth)->default_value(spec.depth), "length of the reference chains")
+    ("rotations", po::value<double>(&spec.rotationDensity)->default_value(spec.rotationDensity), "fraction of chains in a rotated frame")
+    ("boundaries", po::value<unsigned>(&spec.boundaryPoints)->default_value(spec.boundaryPoints), "[N/E/W] world-wall points per file")
+    ("seed", po::value<std::uint64_t>(&spec.seed)->default_value(spec.seed), "random seed")
+    ("workdir", po::value<string>(&workdir)->default_value("bench_work"), "directory for the generated corpora and outputs")
+    ("executable", po::value<string>(&executable_)->default_value("Run/bin/ProduceSimpleConfig"), "ProduceSimpleConfig for the end-to-end benchmark")
+    ("jobs", po::value<unsigned>(&jobs_)->default_value(jobs_), "--jobs passed to ProduceSimpleConfig, and threads for classify and the table loader")
+    ("repeat", po::value<unsigned>(&repeat_)->default_value(repeat_), "runs per benchmark, the best is reported")
+    ("table", po::value<size_t>(&tableRows_)->default_value(tableRows_), "rows of the table for the table loaders (0 skips them)")
+    ;
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) { cout << desc << "\n"; return 1; }
+  if ( sizes.empty() ) sizes = { "99x20", "99x100", "100x1000", "1000x100" };
+
+  // The end-to-end benchmark runs in the corpus directory
+  char resolved[PATH_MAX];
+  if ( ::realpath( executable_.c_str(), resolved ) != nullptr ) executable_ = resolved;
+  else                                                          executable_.clear();
+
+  try {
+    ::mkdir( workdir.c_str(), 0777 );
+    for ( const auto& size : sizes ) {
+      const size_t x = size.find('x');
+      if ( x == string::npos ) throw runtime_error( "Corpus size must be FILESxVERTICES: "+size );
+      spec.files    = stoul( size.substr( 0, x ) );
+      spec.vertices = stoul( size.substr( x+1 ) );
+      runCorpus( spec, workdir );
+    }
+    if ( tableRows_ > 0 ) runTable( workdir );
+  }
+  catch ( const std::exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+}
+
+namespace {
+
+  //=================================================
+  void runCorpus( const bench::CorpusSpec& spec, const string& workdir ) {
+
+    const string dir    = workdir+"/"+to_string( spec.files )+"x"+to_string( spec.vertices );
+    const string outdir = dir+"/output/";
+    ::mkdir( dir.c_str(), 0777 );
+    ::mkdir( (dir+"/geom").c_str(), 0777 );
+    ::mkdir( outdir.c_str(), 0777 );
+
+    const vector<string> files = bench::writeCorpus( spec, dir+"/geom" );
+
+    // Coordinate lines, i.e. all lines but VolName and Height
+    vector<string> lines;
+    for ( const auto& file : files ) {
+      MappedLineReader reader( file );
+      string_view entry;
+      for ( unsigned counter(0) ; reader.next( entry ) ; ++counter ) {
+        if ( counter > 1 ) lines.emplace_back( entry );
+      }
+    }
+
+    const size_t nVertices = lines.size();
+    cout << " Corpus " << dir << ": " << spec.files << " files, " << nVertices << " coordinates" << endl;
+
+    report( "parse", timeBest( [&]{
+          double sum(0.);
+          for ( const auto& line : lines ) sum += Coordinate( line ).getCoordRel().at(0);
+          sink_ = sum;
+        } ), nVertices );
+
+    vector<CoordinateCollection> collections;
+    report( "collection", timeBest( [&]{
+          for ( const auto& file : files ) collections.emplace_back( file, worldCorners );
+        }, [&]{ collections.clear(); collections.reserve( files.size() ); } ), nVertices );
+
+    checkCorpus( collections );
+
+    vector<CoordinateCollection> work;
+    report( "boundaries", timeBest( [&]{
+          for ( auto& ccoll : work ) ccoll.addWorldBoundaries();
+        }, [&]{ work = collections; } ), nVertices );
+
+    Config config;
+    report( "write", timeBest( [&]{
+          for ( const auto& ccoll : collections ) ccoll.printSimpleConfigFile( config, outdir );
+        }, [&]{
+          for ( const auto& output : config.outputFiles ) std::remove( output.c_str() );
+          config = Config();
+        } ), nVertices );
+
+    report( "unchanged", timeBest( [&]{
+          for ( const auto& ccoll : collections ) ccoll.printSimpleConfigFile( config, outdir );
+        }, [&]{ config = Config(); } ), nVertices );
+
+    vector<SimpleConfigVolume> volumes;
+    for ( const auto& ccoll : collections ) volumes.push_back( ccoll.simpleConfigVolume() );
+    const VolumeLocator locator( volumes );
+
+    // Points in the box spanned by the volumes (polygon x/y are Mu2e z/x)
+    array<double,3> lo, hi;
+    lo.fill( numeric_limits<double>::max() );
+    hi.fill( numeric_limits<double>::lowest() );
+    for ( const auto& v : volumes ) {
+      for ( size_t i(0) ; i < v.x.size() ; ++i ) {
+        lo[0] = min( lo[0], v.y[i]+v.offsetFromMu2eOriginX ); hi[0] = max( hi[0], v.y[i]+v.offsetFromMu2eOriginX );
+        lo[2] = min( lo[2], v.x[i]+v.offsetFromMu2eOriginZ ); hi[2] = max( hi[2], v.x[i]+v.offsetFromMu2eOriginZ );
+      }
+      lo[1] = min( lo[1], v.yMin ); hi[1] = max( hi[1], v.yMax );
+    }
+
+    mt19937_64 engine( spec.seed );
+    vector<VolumeLocator::Point> points( 1 << 22 );
+    for ( auto& point : points ) {
+      for ( size_t a(0) ; a < 3 ; ++a ) point[a] = uniform_real_distribution<double>( lo[a], hi[a] )( engine );
+    }
+
+    vector<uint32_t> ids( points.size() );
+    report( "classify", timeBest( [&]{
+          locator.classify( points, ids, jobs_ );
+          sink_ = ids.back();
+        } ), points.size(), "point" );
+
+    if ( executable_.empty() ) {
+      cout << "  (no ProduceSimpleConfig executable, skipping runJob)" << endl;
+      return;
+    }
+
+    auto run = [&]( const string& options ){
+      ostringstream command;
+      command << "cd " << dir << " && " << executable_ << " --jobs " << jobs_ << options
+              << " geom/*.ccl > /dev/null";
+      if ( std::system( command.str().c_str() ) != 0 )
+        throw runtime_error( "Command failed: "+command.str() );
+    };
+
+    report( "runJob", timeBest( [&]{ run( " --force 1" ); } ), nVertices );
+    report( "runJob (inc)", timeBest( [&]{ run( "" ); } ), nVertices );
+
+  }
+
+  //=================================================
+  void checkCorpus( const vector<CoordinateCollection>& collections ) {
+
+    // The timings are only meaningful on valid geometry: the polygon
+    // of every volume and of its inferred dirt must be simple
+    for ( CoordinateCollection ccoll : collections ) {
+      for ( const bool dirt : { false, true } ) {
+        if ( dirt && !( CoordinateCollection::hasOuterPoints( ccoll ) && ccoll.addWorldBoundaries() ) ) continue;
+        const auto polygon = dirt ? ccoll.outlinePolygon() : ccoll.drawnPolygon();
+        const PolygonCheck check = checkPolygon( polygon.x, polygon.y );
+        if ( !check.valid() )
+          throw runtime_error( "Invalid synthetic polygon: "+string( dirt ? "dirt." : "" )+ccoll.volName()+": "+check.problems.front().describe() );
+      }
+    }
+  }
+
+  //=================================================
+  template <const unsigned N>
+  void checkTable( const Table<N>& reference, const ColumnarTable<N>& table, const string& what ) {
+    if ( table.getNrows() != reference.getNrows() )
+      throw runtime_error( "Columnar table ("+what+") has "+to_string( table.getNrows() )+" rows, loadTable "+to_string( reference.getNrows() ) );
+    for ( unsigned i(0) ; i < table.getNrows() ; ++i ) {
+      if ( table.getRow( i ) != reference.getRow( i ) )
+        throw runtime_error( "Columnar table ("+what+") differs from loadTable in row "+to_string( i ) );
+    }
+  }
+
+  //=================================================
+  void runTable( const string& workdir ) {
+
+    // A key and four numbers per row, written with 6 to 17 significant
+    // digits, some in exponent form and some negative
+    const string tableFile = workdir+"/table.txt";
+    const string cacheFile = workdir+"/table.cache";
+    {
+      mt19937_64 engine( 1 );
+      uniform_real_distribution<double> energy( 0., 105. ), weight( -1., 1. );
+      string text;
+      char   line[160];
+      for ( size_t i(0) ; i < tableRows_ ; ++i ) {
+        const int digits = 6+i%12;
+        const int length = snprintf( line, sizeof(line), "e%zu %.*g %.*e %.*g %.*g\n", i,
+                                     digits, energy( engine ), digits, weight( engine )*1e-5,
+                                     digits, weight( engine ), 17, energy( engine )*1e3 );
+        text.append( line, length );
+      }
+      writeIfChanged( tableFile, text );
+    }
+    std::remove( cacheFile.c_str() );
+
+    const size_t nRows = tableRows_;
+    cout << " Table " << tableFile << ": " << nRows << " rows of 5 columns" << endl;
+
+    const Table<5> reference = loadTable<5>( tableFile );
+    checkTable( reference, loadColumnarTable<5>( tableFile, 1 ), "one thread" );
+    checkTable( reference, loadColumnarTable<5>( tableFile, jobs_ ), "--jobs threads" );
+    checkTable( reference, loadColumnarTable<5>( tableFile, jobs_, cacheFile ), "cache written" );
+    const ColumnarTable<5> cached = loadColumnarTable<5>( tableFile, jobs_, cacheFile );
+    if ( !cached.fromCache() ) throw runtime_error( "Columnar table was not read from the cache "+cacheFile );
+    checkTable( reference, cached, "from the cache" );
+
+    report( "loadTable", timeBest( [&]{
+          sink_ = loadTable<5>( tableFile ).getRow( nRows-1 ).second.back();
+        } ), nRows, "row" );
+
+    report( "columnar", timeBest( [&]{
+          sink_ = loadColumnarTable<5>( tableFile, 1 ).value( nRows-1, 3 );
+        } ), nRows, "row" );
+
+    if ( jobs_ != 1 ) {
+      report( "columnar (jobs)", timeBest( [&]{
+            sink_ = loadColumnarTable<5>( tableFile, jobs_ ).value( nRows-1, 3 );
+          } ), nRows, "row" );
+    }
+
+    report( "columnar (cache)", timeBest( [&]{
+          sink_ = loadColumnarTable<5>( tableFile, jobs_, cacheFile ).value( nRows-1, 3 );
+        } ), nRows, "row" );
+
+  }
+
+}
@@ -0,0 +1,180 @@
+// Synthetic .ccl corpus for the benchmarks.
+
+#include "Bench/inc/SyntheticCorpus.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+  // Half-width of the square (in inches) covered by the corpus; well
+  // inside the +-50 m world used by ProduceSimpleConfig
+  constexpr double halfWidth = 120*12;
+
+  // The rotations that occur in geom/
+  constexpr double rotations[] = { 13.62, 13.68, 45. };
+
+  // Rounds to the three decimals of an inch that are written out
+  double roundInches( double inches ) {
+    return std::round( inches*1000 )/1000;
+  }
+
+  // Writes a length in inches in the "ft:in" form of the .ccl files.
+  // A zero feet field carries the sign on the inches, as
+  // Coordinate::convert2mm requires.
+  void writeFtInch( std::ostringstream& os, double inches ) {
+    const long long thousandths = std::llround( std::fabs( inches )*1000 );
+    const bool      negative    = inches < 0 && thousandths != 0;
+    const long long ft          = thousandths/12000;
+    const long long rest        = thousandths%12000;
+
+    if ( ft != 0 ) os << ( negative ? "-" : "" ) << ft;
+    else           os << '0';
+    if ( rest == 0 ) return;
+
+    char digits[32];
+    std::snprintf( digits, sizeof(digits), "%s%lld.%03lld",
+                   ( negative && ft == 0 ) ? "-" : "", rest/1000, rest%1000 );
+
+    // Trim trailing zeros (and the point) of the inches
+    std::string in( digits );
+    while ( in.back() == '0' ) in.pop_back();
+    if ( in.back() == '.' ) in.pop_back();
+    os << ':' << in;
+  }
+
+  std::string fileName( const std::string& dir, unsigned fileIndex ) {
+    char name[64];
+    std::snprintf( name, sizeof(name), "bench_volume%05u.ccl", fileIndex );
+    return dir.empty() || dir.back() == '/' ? dir+name : dir+"/"+name;
+  }
+
+}
+
+namespace bench {
+
+  //=========================================================================
+  std::string syntheticVolume( const CorpusSpec& spec, unsigned fileIndex ) {
+
+    if ( spec.vertices < 3 ) throw std::runtime_error( "A synthetic volume needs at least 3 vertices" );
+    if ( spec.depth    < 1 ) throw std::runtime_error( "The reference-chain depth must be at least 1" );
+
+    // One generator per file, so that files can be produced independently
+    std::mt19937_64 random( spec.seed*0x9e3779b97f4a7c15ULL + fileIndex );
+    std::uniform_real_distribution<double> uniform( 0., 1. );
+
+    // Place the volume in its grid cell
+    const unsigned perRow = static_cast<unsigned>( std::ceil( std::sqrt( double( spec.files ) ) ) );
+    const double   cell   = 2*halfWidth/perRow;
+    const double   xc     = -halfWidth + cell*( fileIndex%perRow + 0.5 );
+    const double   yc     = -halfWidth + cell*( fileIndex/perRow + 0.5 );
+    const double   radius = 0.4*cell;
+
+    // Vertices run clockwise from due east, so the northern half (where
+    // the outline and the world-wall points are) is the last stretch.
+    // It lies on an arc, from west to east, and starts and ends with a
+    // world-wall point, so that the inferred dirt polygon (the stretch,
+    // the projections of its wall points and the world corners) is
+    // simple: the projections go west from its first vertex, north from
+    // the inner ones and east from its last one, and cannot cross it.
+    const unsigned n = spec.vertices;
+    const unsigned firstNorth = n/2+1;
+    const unsigned nNorth     = n-firstNorth;
+    const unsigned nBoundary  = std::min( spec.boundaryPoints, nNorth );
+    const double   arcRadius  = 0.85*radius;
+
+    // Wall of the j-th vertex of the northern stretch, or none: nBoundary
+    // of them, evenly spread and including both ends; [W] and [E] at the
+    // ends only when there is an [N] point between them
+    auto wall = [&]( unsigned j ) -> const char* {
+      if ( nBoundary == 0 ) return nullptr;
+      if ( nBoundary == 1 || nNorth == 1 ) return j == nNorth/2 ? "[N]" : nullptr;
+      const bool boundary = j == 0 || j*( nBoundary-1 )/( nNorth-1 ) != ( j-1 )*( nBoundary-1 )/( nNorth-1 );
+      if ( !boundary ) return nullptr;
+      if ( nBoundary > 2 && j == 0        ) return "[W]";
+      if ( nBoundary > 2 && j == nNorth-1 ) return "[E]";
+      return "[N]";
+    };
+
+    std::ostringstream os;
+    os << "VolName)bench.volume" << fileIndex << '\n';
+    os << "Height)0,12:6\n";
+    os << "*)0,0\n";
+
+    // Outline vertices have lowercase labels
+    auto label = [&]( unsigned k ){
+      return ( nBoundary > 0 && k >= firstNorth ? "p" : "P" )+std::to_string( k );
+    };
+
+    double refX(0.), refY(0.), phi(0.);
+    for ( unsigned k(0) ; k < n ; ++k ) {
+
+      const bool   north = k >= firstNorth;
+      const double theta = -2*M_PI*k/n;
+      const double star  = radius*( 0.7 + 0.3*uniform( random ) );
+      const double r     = north ? arcRadius : star;
+      const double x     = xc + r*std::cos( theta );
+      const double y     = yc + r*std::sin( theta );
+
+      os << label( k ) << ')';
+
+      if ( north ) {
+        if ( const char* boundary = wall( k-firstNorth ) ) os << boundary;
+      }
+
+      // Chain anchors are given wrt the origin, in a frame that is
+      // rotated with probability rotationDensity; the other vertices
+      // wrt the previous vertex, inheriting its rotation
+      if ( k%spec.depth == 0 ) {
+        phi  = uniform( random ) < spec.rotationDensity ? rotations[ random()%3 ] : 0.;
+        refX = 0.;
+        refY = 0.;
+        os << "<*|" << phi << '>';
+      }
+      else {
+        os << '<' << label( k-1 ) << '>';
+      }
+
+      // Express the offset in the rotated frame, round it, and track
+      // the position the rounded offset actually leads to
+      const double c    = std::cos( phi*M_PI/180 );
+      const double s    = std::sin( phi*M_PI/180 );
+      const double relX = roundInches(  c*( x-refX ) + s*( y-refY ) );
+      const double relY = roundInches( -s*( x-refX ) + c*( y-refY ) );
+
+      writeFtInch( os, relX );
+      os << ',';
+      writeFtInch( os, relY );
+      os << '\n';
+
+      const double absX = refX + c*relX - s*relY;
+      const double absY = refY + s*relX + c*relY;
+      refX = absX;
+      refY = absY;
+    }
+
+    return os.str();
+  }
+
+  //=========================================================================
+  std::vector<std::string> writeCorpus( const CorpusSpec& spec, const std::string& dir ) {
+
+    std::vector<std::string> names;
+    names.reserve( spec.files );
+
+    for ( unsigned i(0) ; i < spec.files ; ++i ) {
+      names.push_back( fileName( dir, i ) );
+      std::ofstream out( names.back() );
+      if ( !out.is_open() ) throw std::runtime_error( "Cannot write file: "+names.back() );
+      out << syntheticVolume( spec, i );
+    }
+
+    return names;
+  }
+
+} // end of namespace bench
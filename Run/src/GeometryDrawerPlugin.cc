@@ -0,0 +1,95 @@
+// The ROOT drawing plugin of ProduceSimpleConfig, loaded with --draw
+// (see Utilities/inc/GeometryDrawer.hh).
+
+// C++ includes
+#include <memory>
+
+// ROOT includes
+#include "TApplication.h"
+#include "TCanvas.h"
+#include "TGeoManager.h"
+#include "TGeoMaterial.h"
+#include "TGeoMatrix.h"
+#include "TGeoMedium.h"
+#include "TGeoVolume.h"
+#include "TGeoXtru.h"
+#include "TPad.h"
+#include "TStyle.h"
+
+// Utilities
+#include "Utilities/inc/GeometryDrawer.hh"
+
+namespace {
+
+  class TGeoDrawer : public util::GeometryDrawer {
+
+  public:
+
+    TGeoDrawer( int* argc, char** argv, double dx, double dy, double dz )
+      : app_( std::make_unique<TApplication>( "App", argc, argv ) )
+    {
+      // Set up geometry parameters/volumes
+      TGeoMaterial* matVacuum = new TGeoMaterial("Vacuum",0,0,0);
+      TGeoMaterial* matAl     = new TGeoMaterial("Al",26.98,13,2.7);
+
+      TGeoMedium* medVacuum = new TGeoMedium("Vacuum",1,matVacuum);
+      medAl_                = new TGeoMedium("Wall material",2,matAl);
+
+      rot_ = new TGeoRotation("rot",0.,-90.,-90.);
+
+      // Make top-level volumes
+      top_ = gGeoManager->MakeBox("TOP",medVacuum,dx,dy,dz);
+      gGeoManager->SetTopVolume(top_);
+    }
+
+    void addVolume( const std::string& name,
+                    std::span<const double> x, std::span<const double> y,
+                    double base, double top, Style style ) override {
+
+      TGeoVolume* vol = gGeoManager->MakeXtru( name.data(), medAl_, 2);
+      TGeoXtru*  poly = (TGeoXtru*)vol->GetShape();
+
+      poly->DefinePolygon( x.size(), x.data(), y.data() );
+
+      poly->DefineSection( 0,base,0,0,1 );
+      poly->DefineSection( 1,top ,0,0,1 );
+
+      switch ( style ) {
+      case Foundation : vol->SetLineColor(kGray); break;
+      case Floor      : vol->SetLineColor(28);    break;
+      case Dirt       : vol->SetLineColor(21);    break;
+      default         : vol->SetLineColor(45);    break;
+      }
+
+      top_->AddNode( vol, 1, rot_ );
+    }
+
+    void draw() override {
+
+      gGeoManager->CloseGeometry();
+      gGeoManager->SetVisLevel(3);
+
+      TCanvas c2;
+
+      // Plotting options
+      gStyle->SetCanvasPreferGL(kTRUE);
+
+      top_->Draw("ogl");
+      gPad->WaitPrimitive();
+    }
+
+  private:
+
+    std::unique_ptr<TApplication> app_;
+
+    TGeoMedium*   medAl_;
+    TGeoVolume*   top_;
+    TGeoRotation* rot_;
+
+  };
+
+}
+
+extern "C" util::GeometryDrawer* createGeometryDrawer( int* argc, char** argv, double dx, double dy, double dz ) {
+  return new TGeoDrawer( argc, argv, dx, dy, dz );
+}
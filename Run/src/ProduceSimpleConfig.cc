@@ -1,44 +1,45 @@
 // C++ includes
 #include <algorithm>
 #include <assert.h>
+#include <chrono>
 #include <cmath>
 #include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <map>
 #include <memory>
-
-// ROOT includes
-#include "TCanvas.h"
-#include "TFile.h"
-#include "TGeoManager.h"
-#include "TGeoMedium.h"
-#include "TGeoManager.h"
-#include "TGeoMaterial.h"
-#include "TGeoPainter.h"
-#include "TGeoMatrix.h"
-#include "TGeoVolume.h"
-#include "TGeoXtru.h"
-#include "TGLViewer.h"
-#include "TApplication.h"
-#include "TLine.h"
-#include "TPad.h"
-#include "TString.h"
-#include "TStyle.h"
-#include "TText.h"
-#include "TTree.h"
-#include "TView.h"
+#include <optional>
+#include <sstream>
+#include <sys/stat.h>
 
 // BOOST options - silence unused local typedefs warnings
 #pragma GCC diagnostic ignored "-Wunused-local-typedefs"
 #include "boost/program_options.hpp"
 
 // Utilities
-#include "Utilities/inc/HelperFunctions.hh"
+#include "Utilities/inc/AnchorRegistry.hh"
+#include "Utilities/inc/BinaryGeometryWriter.hh"
+#include "Utilities/inc/CclBundle.hh"
 #include "Utilities/inc/Coordinate.hh"
 #include "Utilities/inc/CoordinateCollection.hh"
 #include "Utilities/inc/Table.hh"
 #include "Utilities/inc/Config.hh"
+#include "Utilities/inc/ConvexDecomposition.hh"
+#include "Utilities/inc/DirectoryWatcher.hh"
+#include "Utilities/inc/DirtComplement.hh"
+#include "Utilities/inc/EmbeddedGeometryWriter.hh"
+#include "Utilities/inc/GeometryDrawer.hh"
+#include "Utilities/inc/Manifest.hh"
+#include "Utilities/inc/MappedFile.hh"
+#include "Utilities/inc/OutputFile.hh"
+#include "Utilities/inc/OverlapCheck.hh"
+#include "Utilities/inc/PolygonCheck.hh"
+#include "Utilities/inc/Profiler.hh"
+#include "Utilities/inc/SimpleConfigWriter.hh"
+#include "Utilities/inc/TextBuffer.hh"
+#include "Utilities/inc/VolumeMerge.hh"
+#include "Utilities/inc/parallelFor.hh"
 
 using namespace std;
 using namespace util;
@@ -46,26 +47,83 @@ namespace po = boost::program_options;
 
 namespace {
 
-  TGeoMaterial* matVacuum;
-  TGeoMaterial* matAl;
-
-  TGeoMedium* medVacuum;
-  TGeoMedium* medAl;
-
-  TGeoVolume* top;
-  TGeoRotation* rot;
-
-  bool draw_    = false;
-  bool verbose_ = false;
+  // Loaded with --draw only
+  unique_ptr<GeometryDrawer> drawer_;
+
+  bool     draw_    = false;
+  bool     verbose_ = false;
+  unsigned jobs_    = 1;
+  bool     force_   = false;
+  bool     check_   = true;
+  string   binary_;
+  string   embed_;
+  string   overlaps_;
+  bool     dirtComplement_ = false;
+  bool     merge_   = false;
+  string   convex_;
+  bool     fixed_   = false;
+
+  // With --merge or --convex the SimpleConfig files are formatted while
+  // the .ccl files are processed and written once all volumes are known
+  bool deferred() { return merge_ || !convex_.empty(); }
+
+  // Resolved at startup (and by --watch when the file changes),
+  // read-only while the files are processed
+  unique_ptr<const AnchorRegistry> anchors_;
+
+  const string manifestFile = "output/.ProduceSimpleConfig.manifest";
+
+  // Half-lengths of the world (mm)
+  const double dx = 50000;
+  const double dy = 50000;
+  const double dz = 50000;
 
-  Config masterConfig;
+  // What processing one .ccl file produces
+  struct FileOutput {
+    Config                     config;
+    vector<SimpleConfigVolume> volumes;
+    vector<SimpleConfigVolume> dirt;      // with --dirt complement, not written
+    vector<string>             files;     // if deferred(), the SimpleConfig files of volumes, written at the end
+    vector<string>             problems;  // of the polygon checks
+  };
+
+  // One .ccl file to process: a file, or a volume of a bundle, whose
+  // text is a view into the bundle's mapping and whose name (used in
+  // the manifest and in messages) is bundle:volume
+  struct Input {
+    string           name;
+    bool             inBundle = false;
+    std::string_view text;
+  };
+
+  // Bump when the content or format of the output files changes, so
+  // that manifest entries written by older versions are not reused.
+  const string generatorVersion = "ProduceSimpleConfig-3";
 
 }
 
-void runJob(const vector<string>& arguments );
-void constructPolygon     ( const CoordinateCollection& filename );
-void constructDirtInferred(       CoordinateCollection  filename );
-void constructDirtPolygon (       CoordinateCollection  filename );
+void runJob(const vector<Input>& inputs );
+vector<Input> expandBundles( const vector<string>& args, vector<unique_ptr<const CclBundle>>& bundles );
+void watchDirectory       ( const string& directory );
+map<worldDir::enum_type,Coordinate::Rep<double>> makeWorldCorners();
+std::uint64_t settingsHash( const map<worldDir::enum_type,Coordinate::Rep<double>>& worldCorners );
+void processFile          ( const string& filename, std::string_view text, const map<worldDir::enum_type,Coordinate::Rep<double>>& worldCorners, FileOutput& output );
+void appendConfig         ( Config& masterConfig, const Config& config );
+void sortConfig           ( Config& masterConfig );
+void printMasterConfig    ( const Config& masterConfig );
+void constructPolygon     ( const CoordinateCollection& filename, FileOutput& output );
+void constructDirtInferred(       CoordinateCollection  filename, FileOutput& output );
+void constructDirtPolygon (       CoordinateCollection  filename, FileOutput& output );
+void validatePolygon      ( const CoordinateCollection& ccoll, const CoordinateCollection::PolygonView& polygon, vector<string>& problems );
+void printProblems        ( const vector<string>& problems );
+void writeVolumeFiles     ( vector<SimpleConfigVolume> volumes );
+void printOverlaps        ( const vector<SimpleConfigVolume>& volumes );
+void addDirtComplement    ( const vector<SimpleConfigVolume>& dirt, Config& masterConfig, vector<SimpleConfigVolume>& volumes, vector<string>& files );
+void mergeAdjacentVolumes ( vector<SimpleConfigVolume>& volumes, vector<string>& files );
+void decomposeVolumes     ( vector<SimpleConfigVolume>& volumes, vector<string>& files );
+void writeDeferredFiles   ( const vector<SimpleConfigVolume>& volumes, const vector<string>& files, Config& masterConfig );
+void emitVolume           ( const CoordinateCollection& ccoll, FileOutput& output, const bool outline );
+void printProblems        ( const vector<SimpleConfigVolume>& volumes );
 
 //=================================================
 int main(int argc, char* argv[]) {
@@ -76,174 +134,682 @@ int main(int argc, char* argv[]) {
     ("help", "produce help message")
     ("draw", po::value<bool>()->default_value(false), "draw flag [default is false]")
     ("verbose", po::value<bool>()->default_value(false), "print coordinate attributes [default is false]")
+    ("jobs", po::value<unsigned>()->default_value(1), "number of files processed concurrently, 0 for one per core [default is 1]")
+    ("force", po::value<bool>()->default_value(false), "regenerate every volume, ignoring the manifest [default is false]")
+    ("check", po::value<bool>()->default_value(true), "check that the polygon of every generated volume is simple [default is true]")
+    ("profile", po::value<string>(), "write per-stage timings and counters as JSON to this file")
+    ("watch", po::value<string>(), "keep running and regenerate the volumes of this directory's .ccl files as they are edited")
+    ("binary", po::value<string>(), "also write every resolved volume to this binary geometry file")
+    ("embed", po::value<string>(), "also write every resolved volume as constexpr arrays to this C++ header")
+    ("overlaps", po::value<string>(), "check all volumes for overlaps and write them to this file")
+    ("dirt", po::value<string>()->default_value("files"), "dirt volumes: \"files\" (one per .ccl file) or \"complement\" (non-overlapping, per height slab) [default is files]")
+    ("merge", po::value<bool>()->default_value(false), "merge volumes of the same height range and material that share boundary edges [default is false]")
+    ("convex", po::value<string>(), "split concave volumes into convex pieces and write the estimated navigation cost of each volume to this file")
+    ("fixed", po::value<bool>()->default_value(false), "resolve references through exact lengths and quarter-turn rotations in integer units of 1/128000 inch [default is false]")
+    ("to-bundle", po::value<string>(), "write the given .ccl files to this bundle (.cclb) and exit")
+    ("from-bundle", po::value<string>(), "write the volumes of the given bundles as .ccl files to this directory and exit")
+    ("anchors", po::value<string>()->default_value("anchors/mu2eHall.anchors"), "file of the anchor points that .ccl files refer to as <@label> [used if present]")
     ;
 
+  // I/O to get .ccl files
+  po::options_description hidden;
+  hidden.add_options()("input-files", po::value<vector<string>>(), ".ccl files and bundles");
+
+  po::options_description all;
+  all.add(desc).add(hidden);
+
+  po::positional_options_description positional;
+  positional.add("input-files", -1);
+
   po::variables_map vm;
-  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::store(po::command_line_parser(argc, argv).options(all).positional(positional).run(), vm);
   po::notify(vm);
 
   if (vm.count("help"))   { cout << desc << "\n"; return 1; }
   if (vm.count("draw"))   { draw_    = vm["draw"]   .as<bool>();  }
   if (vm.count("verbose")){ verbose_ = vm["verbose"].as<bool>();  }
+  if (vm.count("jobs"))   { jobs_    = vm["jobs"]   .as<unsigned>(); }
+  if (vm.count("force"))  { force_   = vm["force"]  .as<bool>();  }
+  if (vm.count("check"))  { check_   = vm["check"]  .as<bool>();  }
+  if (vm.count("binary")) { binary_  = vm["binary"] .as<string>(); }
+  if (vm.count("embed"))  { embed_   = vm["embed"]  .as<string>(); }
+  if (vm.count("overlaps")){ overlaps_= vm["overlaps"].as<string>(); }
+  if (vm.count("merge")) { merge_   = vm["merge"]  .as<bool>();  }
+  if (vm.count("convex")){ convex_  = vm["convex"] .as<string>(); }
+  if (vm.count("fixed"))  { fixed_   = vm["fixed"]  .as<bool>();  }
+  if (vm.count("dirt")) {
+    const string dirt = vm["dirt"].as<string>();
+    if ( dirt != "files" && dirt != "complement" ) { cerr << " Unknown --dirt " << dirt << endl; return 1; }
+    dirtComplement_ = dirt == "complement";
+  }
 
-  // I/O to get .ccl files
-  vector<string> args ( argv
-                        + 1
-                        + draw_
-                        + verbose_
-                        , argv+argc );
+  vector<string> args;
+  if (vm.count("input-files")) args = vm["input-files"].as<vector<string>>();
 
-  TApplication theApp("App",&argc,argv);
-  runJob( args );
+  // Conversions between .ccl files and bundles
+  try {
+    if (vm.count("to-bundle")) {
+      writeCclBundle( args, vm["to-bundle"].as<string>() );
+      return 0;
+    }
+    if (vm.count("from-bundle")) {
+      for ( const auto& bundle : args ) splitCclBundle( bundle, vm["from-bundle"].as<string>() );
+      return 0;
+    }
+  }
+  catch ( const std::exception& e ) {
+    cerr << " " << e.what() << endl;
+    return 1;
+  }
 
-}
+  if (vm.count("profile")) Profiler::enable();
 
-//=================================================
-void runJob( const vector<string>& args ) {
+  // The default anchors file is optional, one given explicitly is not
+  const string anchorsFile = vm["anchors"].as<string>();
+  struct stat anchorsInfo;
+  if ( !vm["anchors"].defaulted() || ::stat( anchorsFile.c_str(), &anchorsInfo ) == 0 ) {
+    anchors_ = make_unique<const AnchorRegistry>( anchorsFile );
+    if ( verbose_ ) cout << " Anchors: " << anchors_->size() << " from " << anchorsFile << endl;
+  }
 
-  const double dx = 50000;
-  const double dy = 50000;
-  const double dz = 50000;
+  if (vm.count("watch")) {
+    if ( draw_ ) { cerr << " --watch cannot be combined with --draw" << endl; return 1; }
+    watchDirectory( vm["watch"].as<string>() );
+    return 0;
+  }
 
-  std::map< worldDir::enum_type, Coordinate::Rep<double>> worldCorners =
-    {{
-        {worldDir::NW,{-dx, dy}}, // NW corner
-        {worldDir::NE,{ dx, dy}}, // NE "
-        {worldDir::SE,{ dx,-dy}}, // SE "
-        {worldDir::SW,{-dx,-dy}}  // SW "
-      }};
+  if ( draw_ ) {
+    UTIL_PROFILE_SCOPE( TGeo );
+    try {
+      drawer_ = loadGeometryDrawer( argc, argv, dx, dy, dz );
+    }
+    catch ( const std::exception& e ) {
+      cerr << " " << e.what() << endl;
+      return 1;
+    }
+  }
 
+  // The bundles stay mapped while their volumes are processed
+  vector<unique_ptr<const CclBundle>> bundles;
+  runJob( expandBundles( args, bundles ) );
 
-  if ( draw_ ) {
-    // Set up geometry parameters/volumes
-    matVacuum = new TGeoMaterial("Vacuum",0,0,0);
-    matAl     = new TGeoMaterial("Al",26.98,13,2.7);
+  if (vm.count("profile")) Profiler::writeJson( vm["profile"].as<string>() );
 
-    medVacuum = new TGeoMedium("Vacuum",1,matVacuum);
-    medAl     = new TGeoMedium("Wall material",2,matAl);
+}
 
-    rot       = new TGeoRotation("rot",0.,-90.,-90.);
+//=================================================
+vector<Input> expandBundles( const vector<string>& args, vector<unique_ptr<const CclBundle>>& bundles ) {
+  vector<Input> inputs;
+  inputs.reserve( args.size() );
+  for ( const auto& arg : args ) {
+    if ( !CclBundle::isBundle( arg ) ) {
+      inputs.push_back( { arg } );
+      continue;
+    }
+    UTIL_PROFILE_SCOPE( Load );
+    bundles.push_back( make_unique<const CclBundle>( arg ) );
+    for ( const auto& volume : bundles.back()->volumes() ) {
+      inputs.push_back( { arg+":"+string( volume.name ), true, volume.text } );
+    }
+  }
+  return inputs;
+}
+
+//=================================================
+void runJob( const vector<Input>& inputs ) {
+
+  const auto worldCorners = makeWorldCorners();
+
+  // Construct lower-level extruded polygons.  Each file fills its own
+  // Config so that the workers share no state; the lists are merged in
+  // argument order and sorted below, which makes the master config
+  // independent of the number of jobs.  The TGeo volumes are not
+  // thread-safe, so drawing forces a serial run.
+  //
+  // Files whose contents (and the generator settings) match the
+  // manifest are not processed again; their Config and the problems
+  // found by the polygon checks are taken from the manifest.  Drawing,
+  // the binary geometry file, the embedded header, the overlap check,
+  // the dirt complement, merging and the convex decomposition need
+  // every volume, so they always process.
+  const unsigned      nJobs   = draw_ ? 1 : jobs_;
+  const std::uint64_t seed    = settingsHash( worldCorners );
+  const bool          reuse   = !draw_ && !force_ && binary_.empty() && embed_.empty() && overlaps_.empty() && !dirtComplement_ && !deferred();
+
+  Manifest manifest( manifestFile );
+  vector<Manifest::Entry> entries( inputs.size() );
+  vector<FileOutput>      outputs( inputs.size() );
+
+  parallelFor( inputs.size(), nJobs, [&](std::size_t i){
+      const Input& input = inputs[i];
+      UTIL_PROFILE_VOLUME( input.name );
+      Manifest::Entry& entry = entries[i];
+
+      // A file is mapped once, for the hash and for the parsing
+      std::optional<MappedFile> file;
+      std::string_view          text = input.text;
+      if ( !input.inBundle ) {
+        UTIL_PROFILE_SCOPE( Load );
+        text = file.emplace( input.name ).contents();
+      }
+      entry.hash = hashBytes( text, seed );
+
+      const Manifest::Entry* previous = reuse ? manifest.find( input.name, entry.hash ) : nullptr;
+      if ( previous != nullptr ) {
+        if ( verbose_ ) std::cout << " Unchanged file: " << input.name << std::endl;
+        entry.config   = previous->config;
+        entry.problems = previous->problems;
+        return;
+      }
+
+      processFile( input.name, text, worldCorners, outputs[i] );
+      entry.config   = outputs[i].config;
+      entry.problems = outputs[i].problems;
+    } );
 
-    // Make top-level volumes
-    top = gGeoManager->MakeBox("TOP",medVacuum,dx,dy,dz);
-    gGeoManager->SetTopVolume(top);
+  Config masterConfig;
+  vector<SimpleConfigVolume> allVolumes, dirt;
+  vector<string>             files;
+  for ( std::size_t i(0) ; i < inputs.size() ; ++i ) {
+    printProblems( entries[i].problems );
+    manifest.update( inputs[i].name, entries[i] );
+    appendConfig( masterConfig, entries[i].config );
+    std::move( outputs[i].volumes.begin(), outputs[i].volumes.end(), std::back_inserter( allVolumes ) );
+    std::move( outputs[i].dirt   .begin(), outputs[i].dirt   .end(), std::back_inserter( dirt       ) );
+    std::move( outputs[i].files  .begin(), outputs[i].files  .end(), std::back_inserter( files      ) );
+  }
+  if ( merge_            ) mergeAdjacentVolumes( allVolumes, files );
+  if ( dirtComplement_   ) addDirtComplement( dirt, masterConfig, allVolumes, files );
+  if ( !convex_.empty()  ) decomposeVolumes( allVolumes, files );
+  if ( deferred()        ) writeDeferredFiles( allVolumes, files, masterConfig );
+  sortConfig( masterConfig );
+
+  {
+    UTIL_PROFILE_SCOPE( Emit );
+    printMasterConfig( masterConfig );
+    manifest.write();
+    writeVolumeFiles( std::move( allVolumes ) );
   }
 
-  // Construct lower-level extruded polygons
-  for ( const auto& filename : args ) {
-    CoordinateCollection ccoll( filename, worldCorners );
+  if ( draw_ ) drawer_->draw();
+
+}
 
-    // Check for dirt polygon first
-    if ( ccoll.volName().find("dirt.") != std::string::npos ) {
-      if ( verbose_ ) std::cout << " Dirt polygon from file: " << filename << std::endl;
-      constructDirtPolygon ( ccoll );
+//=================================================
+void watchDirectory( const string& directory ) {
+
+  // Every volume of the directory is kept in memory with the hash of
+  // its file and the Config it contributes to mu2eBuilding.txt.  When
+  // files change only those are read and written again, and the master
+  // config is rewritten only if its lists changed.  A change to the
+  // anchors file reloads it and, as it is part of the settings hash,
+  // regenerates every volume.
+  struct Volume {
+    std::uint64_t              hash;
+    Config                     config;
+    vector<SimpleConfigVolume> volumes;
+    vector<SimpleConfigVolume> dirt;
+    vector<string>             files;
+  };
+
+  const auto    worldCorners = makeWorldCorners();
+  std::uint64_t seed         = settingsHash( worldCorners );
+
+  DirectoryWatcher watcher( directory, ".ccl" );
+  const string anchorsFile = anchors_ ? anchors_->filename() : string();
+  if ( anchors_ ) watcher.watchFile( anchorsFile );
+  Manifest manifest( manifestFile );
+  map<string,Volume> volumes;
+
+  // Returns true if the volume was regenerated; errors in a file are
+  // reported and leave its previous state in place
+  auto update = [&]( const string& filename ) {
+    try {
+      const MappedFile    file( filename );
+      const std::uint64_t hash = hashBytes( file.contents(), seed );
+      auto known = volumes.find( filename );
+      if ( known != volumes.end() && known->second.hash == hash ) return false;
+
+      FileOutput output;
+      processFile( filename, file.contents(), worldCorners, output );
+      printProblems( output.problems );
+      manifest.update( filename, { hash, output.config, output.problems } );
+      volumes.insert_or_assign( filename, Volume{ hash, std::move( output.config ), std::move( output.volumes ),
+                                                  std::move( output.dirt ), std::move( output.files ) } );
+      return true;
+    }
+    catch ( const std::exception& e ) {
+      cerr << " Error in " << filename << ": " << e.what() << endl;
+      return false;
+    }
+  };
+
+  auto writeMaster = [&]{
+    Config masterConfig;
+    vector<SimpleConfigVolume> allVolumes, dirt;
+    vector<string>             files;
+    for ( const auto& volume : volumes ) {
+      appendConfig( masterConfig, volume.second.config );
+      allVolumes.insert( allVolumes.end(), volume.second.volumes.begin(), volume.second.volumes.end() );
+      dirt      .insert( dirt      .end(), volume.second.dirt   .begin(), volume.second.dirt   .end() );
+      files     .insert( files     .end(), volume.second.files  .begin(), volume.second.files  .end() );
+    }
+    if ( merge_            ) mergeAdjacentVolumes( allVolumes, files );
+    if ( dirtComplement_   ) addDirtComplement( dirt, masterConfig, allVolumes, files );
+    if ( !convex_.empty()  ) decomposeVolumes( allVolumes, files );
+    if ( deferred()        ) writeDeferredFiles( allVolumes, files, masterConfig );
+    sortConfig( masterConfig );
+    printMasterConfig( masterConfig );
+    manifest.write();
+    writeVolumeFiles( std::move( allVolumes ) );
+  };
+
+  for ( const auto& filename : watcher.files() ) update( filename );
+  writeMaster();
+  cout << " Watching " << directory << " (" << volumes.size() << " volumes)" << endl;
+
+  for (;;) {
+    const DirectoryWatcher::Changes changes = watcher.wait();
+    const auto start = std::chrono::steady_clock::now();
+
+    std::size_t nChanged(0);
+    const bool anchorsRemoved  = anchors_ && std::find( changes.removed .begin(), changes.removed .end(), anchorsFile ) != changes.removed .end();
+    const bool anchorsModified = anchors_ && std::find( changes.modified.begin(), changes.modified.end(), anchorsFile ) != changes.modified.end();
+    if ( anchorsRemoved ) cerr << " Anchors file " << anchorsFile << " removed; keeping the anchors read before" << endl;
+    if ( anchorsModified ) {
+      try {
+        anchors_ = make_unique<const AnchorRegistry>( anchorsFile );
+        seed     = settingsHash( worldCorners );
+        cout << " Reloaded " << anchors_->size() << " anchors from " << anchorsFile << endl;
+        for ( const auto& filename : watcher.files() ) {
+          if ( update( filename ) ) ++nChanged;
+        }
+      }
+      catch ( const std::exception& e ) {
+        cerr << " Error in " << anchorsFile << ": " << e.what() << "; keeping the anchors read before" << endl;
+      }
     }
-    else {
-      if ( verbose_ ) std::cout << " Polygon from file: " << filename << std::endl;
-      constructPolygon     ( ccoll );
 
-      if ( verbose_ ) std::cout << " Dirt inferred from file: " << filename << std::endl;
-      constructDirtInferred( ccoll );
+    for ( const auto& filename : changes.removed ) {
+      if ( filename == anchorsFile ) continue;
+      if ( volumes.erase( filename ) == 0 ) continue;
+      manifest.erase( filename );
+      cout << " Removed " << filename << endl;
+      ++nChanged;
+    }
+    for ( const auto& filename : changes.modified ) {
+      if ( filename == anchorsFile || !update( filename ) ) continue;
+      cout << " Regenerated " << filename << endl;
+      ++nChanged;
     }
+    if ( nChanged == 0 ) continue;
 
+    writeMaster();
+
+    const std::chrono::duration<double,std::milli> elapsed = std::chrono::steady_clock::now()-start;
+    cout << " Updated " << nChanged << " volume(s) in " << elapsed.count() << " ms" << endl;
   }
 
-  // Sort master-config lists
+}
+
+//=================================================
+map<worldDir::enum_type,Coordinate::Rep<double>> makeWorldCorners() {
+  return {{
+      {worldDir::NW,{-dx, dy}}, // NW corner
+      {worldDir::NE,{ dx, dy}}, // NE "
+      {worldDir::SE,{ dx,-dy}}, // SE "
+      {worldDir::SW,{-dx,-dy}}  // SW "
+    }};
+}
+
+//=================================================
+std::uint64_t settingsHash( const map<worldDir::enum_type,Coordinate::Rep<double>>& worldCorners ) {
+
+  ostringstream settings;
+  settings.precision(17);
+  settings << generatorVersion << '\n';
+  for ( const auto& corner : worldCorners ) {
+    settings << corner.first << ' ' << corner.second.at(0) << ' ' << corner.second.at(1) << '\n';
+  }
+  settings << CoordinateCollection::Xoffset << ' ' << CoordinateCollection::Zoffset << '\n';
+  if ( anchors_ ) settings << MappedFile( anchors_->filename() ).contents();
+  if ( dirtComplement_ ) settings << "dirt complement\n";
+  if ( merge_          ) settings << "merge\n";
+  if ( !convex_.empty() ) settings << "convex\n";
+  if ( fixed_           ) settings << "fixed point\n";
+  if ( !check_          ) settings << "no checks\n";
+
+  return hashBytes( settings.str() );
+}
+
+//=================================================
+void processFile( const string& filename,
+                  std::string_view text,
+                  const map<worldDir::enum_type,Coordinate::Rep<double>>& worldCorners,
+                  FileOutput& output ) {
+
+  CoordinateCollection ccoll( text, filename, worldCorners, anchors_.get(), fixed_ );
+
+  // Check for dirt polygon first
+  if ( ccoll.volName().find("dirt.") != std::string::npos ) {
+    if ( verbose_ ) std::cout << " Dirt polygon from file: " << filename << std::endl;
+    constructDirtPolygon ( ccoll, output );
+  }
+  else {
+    if ( verbose_ ) std::cout << " Polygon from file: " << filename << std::endl;
+    constructPolygon     ( ccoll, output );
+
+    if ( verbose_ ) std::cout << " Dirt inferred from file: " << filename << std::endl;
+    constructDirtInferred( ccoll, output );
+  }
+
+}
+
+//=================================================
+void appendConfig( Config& masterConfig, const Config& config ) {
+  masterConfig.bldgFiles   .insert( masterConfig.bldgFiles.end()   , config.bldgFiles.begin()   , config.bldgFiles.end()    );
+  masterConfig.dirtFiles   .insert( masterConfig.dirtFiles.end()   , config.dirtFiles.begin()   , config.dirtFiles.end()    );
+  masterConfig.bldgPrefixes.insert( masterConfig.bldgPrefixes.end(), config.bldgPrefixes.begin(), config.bldgPrefixes.end() );
+  masterConfig.dirtPrefixes.insert( masterConfig.dirtPrefixes.end(), config.dirtPrefixes.begin(), config.dirtPrefixes.end() );
+}
+
+//=================================================
+void sortConfig( Config& masterConfig ) {
   std::sort( masterConfig.bldgFiles.begin()   , masterConfig.bldgFiles.end()    );
   std::sort( masterConfig.dirtFiles.begin()   , masterConfig.dirtFiles.end()    );
   std::sort( masterConfig.bldgPrefixes.begin(), masterConfig.bldgPrefixes.end() );
   std::sort( masterConfig.dirtPrefixes.begin(), masterConfig.dirtPrefixes.end() );
+}
 
-  // Print master config file
-  fstream mf;
-  mf.open( "output/mu2eBuilding.txt", fstream::out );
+//=================================================
+void printMasterConfig( const Config& masterConfig ) {
+
+  TextBuffer mf;
   mf << "// Automatically produced by ProduceSimpleConfig\n\n";
   mf << "// This defines the vertical position of the hall air volume\n";
   mf << "double yOfFloorSurface.below.mu2eOrigin = -2312; // mm -(728.58684' - 721')\n\n";
-  for( const auto& line : masterConfig.bldgFiles ) mf << line << "\n";
-  mf << std::endl;
+  for( const auto& line : masterConfig.bldgFiles ) mf << line << '\n';
+  mf << '\n';
   mf << "vector<string> bldg.prefix.list = {\n" ;
   std::size_t i(0);
   for ( const auto& prefix : masterConfig.bldgPrefixes ) {
-    mf << "  \"" << prefix << "\"";
-    if ( i != masterConfig.bldgPrefixes.size()-1 ) mf << ",";
-    mf << std::endl;
+    mf << "  \"" << prefix << '"';
+    if ( i != masterConfig.bldgPrefixes.size()-1 ) mf << ',';
+    mf << '\n';
     ++i;
   }
   mf << "};\n\n";
-  for( const auto& line : masterConfig.dirtFiles ) mf << line << "\n";
-  mf << std::endl;
+  for( const auto& line : masterConfig.dirtFiles ) mf << line << '\n';
+  mf << '\n';
   mf << "vector<string> dirt.prefix.list = {\n" ;
   i=0;
   for ( const auto& prefix : masterConfig.dirtPrefixes ) {
-    mf << "  \"" << prefix << "\"";
-    if ( i != masterConfig.dirtPrefixes.size()-1 ) mf << ",";
-    mf << std::endl;
+    mf << "  \"" << prefix << '"';
+    if ( i != masterConfig.dirtPrefixes.size()-1 ) mf << ',';
+    mf << '\n';
     ++i;
   }
   mf << "};\n\n";
-  mf << R"(// Local Variables:)" << std::endl;
-  mf << R"(// mode:c++)"         << std::endl;
-  mf << R"(// End:)"             << std::endl;
-  mf.close();
+  mf << "// Local Variables:\n";
+  mf << "// mode:c++\n";
+  mf << "// End:\n";
 
-  if ( !draw_ ) return;
+  writeIfChanged( "output/mu2eBuilding.txt", mf.view() );
 
-  gGeoManager->CloseGeometry();
-  gGeoManager->SetVisLevel(3);
+}
 
-  TCanvas c2;
+//=================================================
+void writeVolumeFiles( vector<SimpleConfigVolume> volumes ) {
 
-  // Plotting options
-  gStyle->SetCanvasPreferGL(kTRUE);
+  // Sorted so that the files do not depend on the order of processing
+  std::sort( volumes.begin(), volumes.end(),
+             []( const SimpleConfigVolume& a, const SimpleConfigVolume& b ){ return a.prefix < b.prefix; } );
 
-  top->Draw("ogl");
-  gPad->WaitPrimitive();
+  if ( !binary_  .empty() ) writeBinaryGeometry( binary_, volumes );
+  if ( !embed_   .empty() ) writeEmbeddedGeometry( embed_, "mu2eHall", volumes );
+  if ( !overlaps_.empty() ) printOverlaps( volumes );
 
 }
 
 //=================================================
-void constructPolygon( const CoordinateCollection& ccoll ) {
+void printOverlaps( const vector<SimpleConfigVolume>& volumes ) {
 
-  if (verbose_) std::cout << " Height: " << ccoll.height().at(0) << " to " << ccoll.height().at(1) << std::endl;
+  const vector<VolumeOverlap> overlaps = findOverlaps( volumes );
+
+  TextBuffer os;
+  os << "// Overlapping volumes, automatically produced by ProduceSimpleConfig\n";
+  os << "//\n";
+  os << "// volume, volume, footprint overlap (mm^2), height overlap (mm), volume overlap (mm^3)\n";
+  for ( const auto& overlap : overlaps ) {
+    os << volumes[overlap.first].prefix << ' ' << volumes[overlap.second].prefix << ' '
+       << overlap.area << ' ' << overlap.height << ' ' << overlap.volume << '\n';
+  }
+  writeIfChanged( overlaps_, os.view() );
+
+  cout << " " << overlaps.size() << " overlapping pairs of volumes, written to " << overlaps_ << endl;
+
+}
+
+//=================================================
+void addDirtComplement( const vector<SimpleConfigVolume>& dirt, Config& masterConfig, vector<SimpleConfigVolume>& volumes, vector<string>& files ) {
 
-  ccoll.printSimpleConfigFile( masterConfig, "output/" );
+  // In this mode volumes holds the buildings only
+  vector<SimpleConfigVolume> complement;
+  {
+    UTIL_PROFILE_SCOPE( DirtInference );
+    complement = dirtComplement( volumes, dirt, dx, dy );
+  }
+  if ( verbose_ ) cout << " Dirt complement: " << complement.size() << " volumes replace " << dirt.size() << endl;
+
+  printProblems( complement );
 
-  vector<double> xPos, yPos;
-  unsigned counter(0);
-  for( const auto& coord : ccoll.coordinates() ) {
-    if ( counter != 0 && coord.drawFlag() ) {
-      if ( verbose_ ) coord.print();
-      xPos.push_back( coord.x() );
-      yPos.push_back( coord.y() );
+  if ( deferred() ) {
+    UTIL_PROFILE_SCOPE( Emit );
+    TextBuffer fs;
+    for ( const auto& volume : complement ) {
+      fs.clear();
+      formatSimpleConfigFile( fs, volume, dirtComplementComment( volume ) );
+      files.emplace_back( fs.view() );
     }
-    ++counter;
+  }
+  else {
+    Config config;
+    printDirtComplement( complement, config, "output/" );
+    appendConfig( masterConfig, config );
   }
 
-  if ( !draw_ ) return;
+  if ( draw_ ) {
+    UTIL_PROFILE_SCOPE( TGeo );
+    for ( const auto& volume : complement ) {
+      drawer_->addVolume( volume.name, volume.x, volume.y, volume.yMin, volume.yMax, GeometryDrawer::Dirt );
+    }
+  }
+
+  volumes.insert( volumes.end(), complement.begin(), complement.end() );
+
+}
+
+//=================================================
+void mergeAdjacentVolumes( vector<SimpleConfigVolume>& volumes, vector<string>& files ) {
+
+  vector<VolumeMerge> merges;
+  {
+    UTIL_PROFILE_SCOPE( Merge );
+    merges = mergeVolumes( volumes, dx, dy );
+  }
+
+  vector<bool> merged( volumes.size(), false );
+  vector<SimpleConfigVolume> pieces;
+  std::size_t nMerged(0);
+  for ( const auto& merge : merges ) {
+    for ( std::size_t i : merge.members ) merged[i] = true;
+    nMerged += merge.members.size();
+    pieces.insert( pieces.end(), merge.volumes.begin(), merge.volumes.end() );
+  }
+  printProblems( pieces );
+
+  vector<SimpleConfigVolume> result;
+  vector<string>             resultFiles;
+  for ( std::size_t i(0) ; i < volumes.size() ; ++i ) {
+    if ( merged[i] ) continue;
+    result     .push_back( std::move( volumes[i] ) );
+    resultFiles.push_back( std::move( files[i] ) );
+  }
+
+  TextBuffer comment, fs;
+  for ( auto& merge : merges ) {
+    comment.clear();
+    comment << "// SimpleConfig geometry file automatically produced by merging:\n";
+    comment << "//\n";
+    for ( std::size_t i : merge.members ) comment << "//   " << volumes[i].prefix << '\n';
+    if ( verbose_ ) cout << " Merged " << merge.members.size() << " volumes into " << merge.volumes.front().prefix << endl;
+    for ( auto& volume : merge.volumes ) {
+      UTIL_PROFILE_SCOPE( Emit );
+      fs.clear();
+      formatSimpleConfigFile( fs, volume, comment.view() );
+      resultFiles.emplace_back( fs.view() );
+      result.push_back( std::move( volume ) );
+    }
+  }
+
+  volumes = std::move( result );
+  files   = std::move( resultFiles );
 
-  TGeoVolume* vol = gGeoManager->MakeXtru( ccoll.volName().data(), medAl, 2);
-  TGeoXtru*  poly = (TGeoXtru*)vol->GetShape();
+  cout << " Merged " << nMerged << " volumes into " << pieces.size() << endl;
 
-  poly->DefinePolygon( xPos.size(), &xPos.front(), &yPos.front() );
+}
 
-  const double base   = ccoll.height().at(0);
-  const double height = ccoll.height().at(1);
+//=================================================
+void decomposeVolumes( vector<SimpleConfigVolume>& volumes, vector<string>& files ) {
 
-  poly->DefineSection( 0,base  ,0,0,1 );
-  poly->DefineSection( 1,height,0,0,1 );
+  vector<ConvexDecomposition> decompositions( volumes.size() );
+  {
+    UTIL_PROFILE_SCOPE( Convex );
+    for ( std::size_t i(0) ; i < volumes.size() ; ++i ) decompositions[i] = decomposeConvex( volumes[i].x, volumes[i].y );
+  }
 
+  // Each piece of a concave volume is a volume of its own, with the
+  // material, height range and offsets of the volume it replaces
+  vector<SimpleConfigVolume> result, pieces;
+  vector<string>             resultFiles;
+  TextBuffer comment, fs, os;
+  os << "// Convex decomposition, automatically produced by ProduceSimpleConfig\n";
+  os << "//\n";
+  os << "// Estimated tests per point located in the extrusion: n+2 planes if convex,\n";
+  os << "// 3n-4 facets if concave (n vertices); after the decomposition, the mean\n";
+  os << "// over the pieces weighted by their areas, and the sum over all pieces.\n";
+  os << "//\n";
+  os << "// volume, vertices, reflex vertices, pieces, cost, cost after (mean), cost after (all pieces), reduction (%)\n";
+  double before(0), after(0);
+  std::size_t nSplit(0);
+  for ( std::size_t i(0) ; i < volumes.size() ; ++i ) {
+    const ConvexDecomposition& decomposition = decompositions[i];
+    if ( decomposition.pieces.empty() ) cerr << " Cannot decompose " << volumes[i].prefix << " into convex pieces" << endl;
+    else {
+      os << volumes[i].prefix << ' ' << decomposition.vertices << ' ' << decomposition.reflex << ' ' << decomposition.pieces.size() << ' '
+         << decomposition.cost << ' ' << decomposition.meanCost << ' ' << decomposition.sumCost << ' '
+         << std::round( 1000.*( 1.-decomposition.meanCost/decomposition.cost ) )/10. << '\n';
+      before += decomposition.cost;
+      after  += decomposition.meanCost;
+    }
+    if ( decomposition.pieces.size() < 2 ) {
+      result     .push_back( std::move( volumes[i] ) );
+      resultFiles.push_back( std::move( files[i] ) );
+      continue;
+    }
+    ++nSplit;
+
+    comment.clear();
+    comment << "// SimpleConfig geometry file automatically produced as one of the\n";
+    comment << "// " << decomposition.pieces.size() << " convex pieces of " << volumes[i].prefix << '\n';
+    for ( std::size_t p(0) ; p < decomposition.pieces.size() ; ++p ) {
+      SimpleConfigVolume volume = volumes[i];
+      volume.prefix += ".convex"+std::to_string( p+1 );
+      volume.name   += "Convex"+std::to_string( p+1 );
+      volume.x       = decomposition.pieces[p].x;
+      volume.y       = decomposition.pieces[p].y;
+      setWorldReplace( volume, dx, dy );
+
+      UTIL_PROFILE_SCOPE( Emit );
+      fs.clear();
+      formatSimpleConfigFile( fs, volume, comment.view() );
+      resultFiles.emplace_back( fs.view() );
+      pieces.push_back( volume );
+      result.push_back( std::move( volume ) );
+    }
+  }
+  printProblems( pieces );
+
+  writeIfChanged( convex_, os.view() );
+
+  volumes = std::move( result );
+  files   = std::move( resultFiles );
+
+  cout << " Split " << nSplit << " concave volumes into " << pieces.size() << " convex pieces, estimated navigation cost "
+       << std::round( 1000.*( 1.-after/before ) )/10. << "% lower; report written to " << convex_ << endl;
+
+}
+
+//=================================================
+void writeDeferredFiles( const vector<SimpleConfigVolume>& volumes, const vector<string>& files, Config& masterConfig ) {
+
+  UTIL_PROFILE_SCOPE( Emit );
+
+  Config config;
+  for ( std::size_t i(0) ; i < volumes.size() ; ++i ) {
+    addSimpleConfigFile( config, volumes[i], "output/" );
+    writeIfChanged( "output/"+volumes[i].name+".txt", files[i] );
+  }
+  appendConfig( masterConfig, config );
+
+}
+
+//=================================================
+void emitVolume( const CoordinateCollection& ccoll, FileOutput& output, const bool outline ) {
+
+  if ( !deferred() ) {
+    output.volumes.push_back( ccoll.printSimpleConfigFile( output.config, "output/", outline ) );
+    return;
+  }
+
+  // Written by writeDeferredFiles, unless merged or decomposed
+  UTIL_PROFILE_SCOPE( Emit );
+  output.volumes.push_back( ccoll.simpleConfigVolume( outline ) );
+  TextBuffer fs;
+  ccoll.formatSimpleConfigFile( fs, output.volumes.back(), outline );
+  output.files.emplace_back( fs.view() );
+
+}
+
+//=================================================
+void constructPolygon( const CoordinateCollection& ccoll, FileOutput& output ) {
+
+  if (verbose_) std::cout << " Height: " << ccoll.height().at(0) << " to " << ccoll.height().at(1) << std::endl;
+
+  const auto polygon = ccoll.drawnPolygon();
+  validatePolygon( ccoll, polygon, output.problems );
+
+  emitVolume( ccoll, output, false );
+  if ( verbose_ ) {
+    for ( std::size_t i : polygon.index ) ccoll.coordinates()[i].print();
+  }
+
+  if ( !draw_ ) return;
+
+  UTIL_PROFILE_SCOPE( TGeo );
+  GeometryDrawer::Style style = GeometryDrawer::Building;
   if      ( ccoll.volName().find("oundation") != std::string::npos ||
-            ccoll.volName().find("rench")     != std::string::npos ) vol->SetLineColor(kGray);
-  else if ( ccoll.volName().find("floor.")    != std::string::npos ) vol->SetLineColor(28);
-  else vol->SetLineColor(45);
+            ccoll.volName().find("rench")     != std::string::npos ) style = GeometryDrawer::Foundation;
+  else if ( ccoll.volName().find("floor.")    != std::string::npos ) style = GeometryDrawer::Floor;
 
-  top->AddNode( vol, 1, rot );
+  drawer_->addVolume( ccoll.volName(), polygon.x, polygon.y, ccoll.height().at(0), ccoll.height().at(1), style );
 
 }
 
 //=================================================
-void constructDirtInferred( CoordinateCollection ccoll ){
+void constructDirtInferred( CoordinateCollection ccoll, FileOutput& output ){
+
+  UTIL_PROFILE_SCOPE( DirtInference );
 
   const bool enoughOuterPoints = CoordinateCollection::hasOuterPoints( ccoll );
   if ( !enoughOuterPoints ) return;
@@ -255,73 +821,93 @@ void constructDirtInferred( CoordinateCollection ccoll ){
 
   ccoll.setName( "dirt."+ccoll.volName() );
 
-  ccoll.printSimpleConfigFile( masterConfig, "output/", true );
+  const auto polygon = ccoll.outlinePolygon();
+  validatePolygon( ccoll, polygon, output.problems );
 
-  vector<double> xPos, yPos;
-  unsigned counter(0);
-  for( const auto& coord : ccoll.coordinates() ) {
-    if ( counter != 0 && coord.drawFlag() && coord.isOutline() ) {
-      if ( verbose_ ) coord.print();
-      xPos.push_back( coord.x() );
-      yPos.push_back( coord.y() );
-    }
-    ++counter;
+  if ( dirtComplement_ ) output.dirt.push_back( ccoll.simpleConfigVolume( true ) );
+  else emitVolume( ccoll, output, true );
+  if ( verbose_ ) {
+    for ( std::size_t i : polygon.index ) ccoll.coordinates()[i].print();
   }
 
-  if ( !draw_ ) return;
+  if ( !draw_ || dirtComplement_ ) return;
+
+  UTIL_PROFILE_SCOPE( TGeo );
+  drawer_->addVolume( ccoll.volName()+"Dirt", polygon.x, polygon.y, ccoll.height().at(0), ccoll.height().at(1), GeometryDrawer::Dirt );
+
+}
+
+//=================================================
+void constructDirtPolygon( CoordinateCollection ccoll, FileOutput& output ){
 
-  TGeoVolume* vol = gGeoManager->MakeXtru( TString(ccoll.volName()+"Dirt"), medAl, 2);
-  TGeoXtru*  poly = (TGeoXtru*)vol->GetShape();
+  if (verbose_ ) std::cout << " Height: " << ccoll.height().at(0) << " to " << ccoll.height().at(1) << std::endl;
 
-  poly->DefinePolygon( xPos.size(), &xPos.front(), &yPos.front() );
+  ccoll.addWorldBoundaries( verbose_ );
 
-  const double base   = ccoll.height().at(0);
-  const double height = ccoll.height().at(1);
+  const auto polygon = ccoll.drawnPolygon();
+  validatePolygon( ccoll, polygon, output.problems );
 
-  poly->DefineSection( 0,base  ,0,0,1 );
-  poly->DefineSection( 1,height,0,0,1 );
+  if ( dirtComplement_ ) output.dirt.push_back( ccoll.simpleConfigVolume() );
+  else emitVolume( ccoll, output, false );
+  if ( verbose_ ) {
+    for ( std::size_t i : polygon.index ) ccoll.coordinates()[i].print();
+  }
 
-  vol->SetLineColor(21);
+  if ( !draw_ || dirtComplement_ ) return;
 
-  top->AddNode( vol, 1, rot );
+  UTIL_PROFILE_SCOPE( TGeo );
+  drawer_->addVolume( ccoll.volName(), polygon.x, polygon.y, ccoll.height().at(0), ccoll.height().at(1), GeometryDrawer::Dirt );
 
 }
 
 //=================================================
-void constructDirtPolygon( CoordinateCollection ccoll ){
+void validatePolygon( const CoordinateCollection& ccoll,
+                      const CoordinateCollection::PolygonView& polygon,
+                      vector<string>& problems ) {
 
-  if (verbose_ ) std::cout << " Height: " << ccoll.height().at(0) << " to " << ccoll.height().at(1) << std::endl;
+  if ( !check_ ) return;
 
-  ccoll.addWorldBoundaries( verbose_ );
+  UTIL_PROFILE_SCOPE( Validate );
+
+  const PolygonCheck check = checkPolygon( polygon.x, polygon.y );
+
+  if ( verbose_ ) std::cout << " Polygon: " << ( check.clockwise() ? "clockwise" : "counter-clockwise" )
+                            << ", area " << std::abs( check.signedArea ) << " mm^2" << std::endl;
 
-  ccoll.printSimpleConfigFile( masterConfig, "output/" );
+  // Name the vertices by their labels, as in the comments of the
+  // SimpleConfig file
+  auto label = [&]( std::size_t i ){ return ccoll.coordinates()[ polygon.index[i] ].label(); };
 
-  vector<double> xPos, yPos;
-  unsigned counter(0);
-  for( const auto& coord : ccoll.coordinates() ) {
-    if ( counter != 0 && coord.drawFlag() ) {
-      if ( verbose_ ) coord.print();
-      xPos.push_back( coord.x() );
-      yPos.push_back( coord.y() );
+  for ( const auto& problem : check.problems ) {
+    string message = ccoll.volName()+": "+problem.describe();
+    switch ( problem.kind ) {
+    case PolygonProblem::ZeroLengthEdge   : message += " ("+label( problem.i )+")"; break;
+    case PolygonProblem::DuplicateVertex  :
+    case PolygonProblem::DuplicateEdge    :
+    case PolygonProblem::SelfIntersection : message += " ("+label( problem.i )+", "+label( problem.j )+")"; break;
+    default : break;
     }
-    ++counter;
+    problems.push_back( message );
   }
 
-  if ( !draw_ ) return;
-
-  TGeoVolume* vol = gGeoManager->MakeXtru( ccoll.volName().data(), medAl, 2);
-  TGeoXtru*  poly = (TGeoXtru*)vol->GetShape();
+}
 
-  poly->DefinePolygon( xPos.size(), &xPos.front(), &yPos.front() );
+//=================================================
+void printProblems( const vector<string>& problems ) {
+  for ( const auto& problem : problems ) cerr << " Invalid polygon: " << problem << endl;
+}
 
-  const double base   = ccoll.height().at(0);
-  const double height = ccoll.height().at(1);
+//=================================================
+void printProblems( const vector<SimpleConfigVolume>& volumes ) {
 
-  poly->DefineSection( 0,base  ,0,0,1 );
-  poly->DefineSection( 1,height,0,0,1 );
+  if ( !check_ ) return;
 
-  vol->SetLineColor(21);
+  UTIL_PROFILE_SCOPE( Validate );
 
-  top->AddNode( vol, 1, rot );
+  vector<string> problems;
+  for ( const auto& volume : volumes ) {
+    for ( const auto& problem : checkPolygon( volume.x, volume.y ).problems ) problems.push_back( volume.prefix+": "+problem.describe() );
+  }
+  printProblems( problems );
 
 }
@@ -0,0 +1,73 @@
+#ifndef util_AnchorRegistry_hh
+#define util_AnchorRegistry_hh
+//
+// Reference points shared by all .ccl files of a run.
+//
+// The anchors file holds coordinate lines in the .ccl syntax, without
+// the VolName and Height lines:
+//
+//   *)0,0
+//   H)<*|0>3:11,20:6
+//   I)<H|45>1:0.25,0
+//
+// As in a .ccl file, the first point is the origin, and the reference
+// and rotation of a point without "<...>" are those of the point above
+// it.  The points are resolved once, when the registry is built, to
+// absolute positions in the frame of the building origin (the "*)0,0"
+// of a .ccl file); the registry is not modified afterwards and can be
+// shared by concurrent CoordinateCollections.
+//
+// A .ccl file refers to an anchor by its label prefixed with "@", as in
+// "g1)<@K|13.68>-2,2:6".  Only the position of the anchor is used: as
+// for any other reference, the rotation comes from the line itself or
+// from the line above it.  Draw flags and wall references do not apply
+// to anchors; a wall reference is an error.
+//
+// Anchors reached from the origin through exact lengths and rotations
+// by multiples of 90 degrees also have an exact position in units of
+// 1/128000 inch (see FixedLength.hh), for the fixed-point mode of
+// CoordinateCollection.
+//
+
+// Utilities includes
+#include "Utilities/inc/Coordinate.hh"
+#include "Utilities/inc/FixedLength.hh"
+
+// C++ includes
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace util {
+
+  class AnchorRegistry {
+
+  public:
+
+    // Prefix of an anchor label in a .ccl reference
+    static constexpr char prefix = '@';
+
+    explicit AnchorRegistry( const std::string& filename );
+
+    // Absolute position (mm) of the anchor with the given label (without
+    // the '@'), nullptr if there is none
+    const Coordinate::Rep<double>* find( std::string_view label ) const;
+
+    // Exact position of the anchor, nullptr if it has none
+    const Coordinate::Rep<FixedLength>* findFixed( std::string_view label ) const;
+
+    const std::string& filename() const { return filename_; }
+    std::size_t        size()     const { return positions_.size(); }
+
+  private:
+
+    std::string filename_;
+    std::unordered_map<std::string,Coordinate::Rep<double>> positions_;
+    std::unordered_map<std::string,Coordinate::Rep<FixedLength>> fixedPositions_;
+
+  };
+
+} // end of namespace util
+
+#endif /* util_AnchorRegistry_hh */
@@ -0,0 +1,252 @@
+#ifndef util_BinaryGeometry_hh
+#define util_BinaryGeometry_hh
+//
+// Binary file of all resolved volumes, and a header-only reader.
+//
+// The file holds the same information as the SimpleConfig files of a
+// run (see SimpleConfigVolume), in a form that can be used straight
+// from a read-only memory mapping: the reader maps the file, checks
+// it once, and hands out string_views and spans that point into the
+// mapping.  Nothing is parsed or copied, and jobs on one node that
+// open the same file share its page-cached copy.
+//
+// Layout (version 1), all offsets in bytes from the start of the file,
+// numbers in the byte order of the machine that wrote the file:
+//
+//   FileHeader
+//   VolumeRecord[nVolumes]       sorted by prefix
+//   per volume: x[nVertices], y[nVertices]          (double)
+//               xReplace[nXReplace], yReplace[...]  (uint32, padded to 8 bytes)
+//   strings (name, prefix, material of each volume; each NUL-terminated)
+//
+// The reader rejects files with another magic, version, byte order or
+// record size, and any offset or length that points outside the file.
+// Only this header is needed to read the file.
+//
+
+// C++ includes
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// POSIX includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace util {
+
+  namespace binaryGeometry {
+
+    constexpr char          magic[8]   = { 'M','U','2','E','B','L','D','G' };
+    constexpr std::uint32_t version    = 1;
+    constexpr std::uint32_t endianTag  = 0x01020304;
+
+    struct FileHeader {
+      char          magic[8];
+      std::uint32_t version;
+      std::uint32_t endianTag;
+      std::uint32_t nVolumes;
+      std::uint32_t recordSize;
+      std::uint64_t fileSize;
+      std::uint64_t recordsOffset;
+    };
+
+    struct VolumeRecord {
+      std::uint64_t nameOffset;
+      std::uint64_t prefixOffset;
+      std::uint64_t materialOffset;
+      std::uint32_t nameLength;
+      std::uint32_t prefixLength;
+      std::uint32_t materialLength;
+      std::uint32_t nVertices;
+      std::uint32_t nXReplace;
+      std::uint32_t nYReplace;
+
+      double yMin;
+      double yMax;
+      double offsetFromMu2eOriginX;
+      double offsetFromFloorSurfaceY;
+      double offsetFromMu2eOriginZ;
+      double yHalfThickness;
+
+      std::uint64_t xOffset;
+      std::uint64_t yOffset;
+      std::uint64_t xReplaceOffset;
+      std::uint64_t yReplaceOffset;
+    };
+
+    static_assert( sizeof(FileHeader)   == 40,  "unexpected padding in FileHeader"   );
+    static_assert( sizeof(VolumeRecord) == 128, "unexpected padding in VolumeRecord" );
+
+  }
+
+  class BinaryGeometry {
+
+  public:
+
+    struct Volume {
+      std::string_view name;
+      std::string_view prefix;
+      std::string_view material;
+
+      double yMin;
+      double yMax;
+      double offsetFromMu2eOriginX;
+      double offsetFromFloorSurfaceY;
+      double offsetFromMu2eOriginZ;
+      double yHalfThickness;
+
+      std::span<const double>        x;
+      std::span<const double>        y;
+      std::span<const std::uint32_t> xReplace;
+      std::span<const std::uint32_t> yReplace;
+    };
+
+    explicit BinaryGeometry( const std::string& filename ) : filename_( filename ) {
+      const int fd = ::open( filename_.c_str(), O_RDONLY );
+      if ( fd < 0 ) fail( "Cannot open file", errno );
+
+      struct stat info;
+      if ( ::fstat( fd, &info ) != 0 ) { const int error = errno; ::close( fd ); fail( "Cannot stat file", error ); }
+
+      size_ = info.st_size;
+      if ( size_ < sizeof(binaryGeometry::FileHeader) ) { ::close( fd ); fail( "File too short" ); }
+
+      void* addr = ::mmap( nullptr, size_, PROT_READ, MAP_SHARED, fd, 0 );
+      const int error = errno;
+      ::close( fd );
+      if ( addr == MAP_FAILED ) fail( "Cannot map file", error );
+      data_ = static_cast<const char*>( addr );
+
+      try { validate(); }
+      catch (...) { unmap(); throw; }
+    }
+
+    ~BinaryGeometry() { unmap(); }
+
+    BinaryGeometry( const BinaryGeometry& ) = delete;
+    BinaryGeometry& operator=( const BinaryGeometry& ) = delete;
+
+    // A moved-from object maps nothing and is empty: size() is 0
+    BinaryGeometry( BinaryGeometry&& other ) noexcept
+      : filename_( std::move( other.filename_ ) )
+      , data_( std::exchange( other.data_, nullptr ) )
+      , size_( std::exchange( other.size_, 0 ) )
+    {}
+
+    BinaryGeometry& operator=( BinaryGeometry&& other ) noexcept {
+      if ( this != &other ) {
+        unmap();
+        filename_ = std::move( other.filename_ );
+        data_     = std::exchange( other.data_, nullptr );
+        size_     = std::exchange( other.size_, 0 );
+      }
+      return *this;
+    }
+
+    std::size_t size() const { return data_ != nullptr ? header().nVolumes : 0; }
+
+    Volume operator[]( std::size_t i ) const {
+      const binaryGeometry::VolumeRecord& r = record( i );
+      return Volume{ string( r.nameOffset, r.nameLength ),
+                     string( r.prefixOffset, r.prefixLength ),
+                     string( r.materialOffset, r.materialLength ),
+                     r.yMin, r.yMax,
+                     r.offsetFromMu2eOriginX, r.offsetFromFloorSurfaceY, r.offsetFromMu2eOriginZ,
+                     r.yHalfThickness,
+                     array<double>( r.xOffset, r.nVertices ),
+                     array<double>( r.yOffset, r.nVertices ),
+                     array<std::uint32_t>( r.xReplaceOffset, r.nXReplace ),
+                     array<std::uint32_t>( r.yReplaceOffset, r.nYReplace ) };
+    }
+
+    // Index of the volume with the given prefix (e.g. "building.dsArea"),
+    // or size() if there is none
+    std::size_t find( std::string_view prefix ) const {
+      std::size_t lo(0), hi( size() );
+      while ( lo < hi ) {
+        const std::size_t mid = lo+(hi-lo)/2;
+        const binaryGeometry::VolumeRecord& r = record( mid );
+        if ( string( r.prefixOffset, r.prefixLength ) < prefix ) lo = mid+1;
+        else hi = mid;
+      }
+      if ( lo < size() && (*this)[lo].prefix == prefix ) return lo;
+      return size();
+    }
+
+    const std::string& filename() const { return filename_; }
+
+  private:
+
+    std::string filename_;
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+
+    const binaryGeometry::FileHeader& header() const {
+      return *reinterpret_cast<const binaryGeometry::FileHeader*>( data_ );
+    }
+
+    const binaryGeometry::VolumeRecord& record( std::size_t i ) const {
+      return reinterpret_cast<const binaryGeometry::VolumeRecord*>( data_+header().recordsOffset )[i];
+    }
+
+    std::string_view string( std::uint64_t offset, std::uint32_t length ) const {
+      return { data_+offset, length };
+    }
+
+    template <typename T>
+    std::span<const T> array( std::uint64_t offset, std::uint32_t n ) const {
+      return { reinterpret_cast<const T*>( data_+offset ), n };
+    }
+
+    bool fits( std::uint64_t offset, std::uint64_t bytes, std::size_t alignment ) const {
+      return offset <= size_ && bytes <= size_-offset && offset%alignment == 0;
+    }
+
+    void validate() const {
+      const binaryGeometry::FileHeader& h = header();
+      if ( std::memcmp( h.magic, binaryGeometry::magic, sizeof(h.magic) ) != 0 ) fail( "Not a binary geometry file" );
+      if ( h.version    != binaryGeometry::version   ) fail( "Unsupported binary geometry version "+std::to_string( h.version ) );
+      if ( h.endianTag  != binaryGeometry::endianTag ) fail( "Binary geometry written with another byte order" );
+      if ( h.recordSize != sizeof(binaryGeometry::VolumeRecord) ) fail( "Unexpected volume record size" );
+      if ( h.fileSize   != size_ ) fail( "File size does not match its header (truncated?)" );
+      if ( !fits( h.recordsOffset, std::uint64_t( h.nVolumes )*sizeof(binaryGeometry::VolumeRecord), 8 ) )
+        fail( "Volume records outside the file" );
+
+      for ( std::size_t i(0) ; i < h.nVolumes ; ++i ) {
+        const binaryGeometry::VolumeRecord& r = record( i );
+        if ( !fits( r.nameOffset    , r.nameLength    , 1 ) ||
+             !fits( r.prefixOffset  , r.prefixLength  , 1 ) ||
+             !fits( r.materialOffset, r.materialLength, 1 ) ||
+             !fits( r.xOffset       , std::uint64_t( r.nVertices )*sizeof(double)       , alignof(double) ) ||
+             !fits( r.yOffset       , std::uint64_t( r.nVertices )*sizeof(double)       , alignof(double) ) ||
+             !fits( r.xReplaceOffset, std::uint64_t( r.nXReplace )*sizeof(std::uint32_t), alignof(std::uint32_t) ) ||
+             !fits( r.yReplaceOffset, std::uint64_t( r.nYReplace )*sizeof(std::uint32_t), alignof(std::uint32_t) ) )
+          fail( "Volume "+std::to_string( i )+" points outside the file" );
+      }
+    }
+
+    void unmap() {
+      if ( data_ != nullptr ) ::munmap( const_cast<char*>( data_ ), size_ );
+      data_ = nullptr;
+      size_ = 0;
+    }
+
+    [[noreturn]] void fail( const std::string& what, int error = 0 ) const {
+      std::string message = what+": "+filename_;
+      if ( error != 0 ) message += " ("+std::string( std::strerror( error ) )+")";
+      throw std::runtime_error( message );
+    }
+
+  };
+
+} // end of namespace util
+
+#endif /* util_BinaryGeometry_hh */
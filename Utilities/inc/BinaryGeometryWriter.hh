@@ -0,0 +1,26 @@
+#ifndef util_BinaryGeometryWriter_hh
+#define util_BinaryGeometryWriter_hh
+//
+// Writing of the binary geometry file read by BinaryGeometry.hh.
+//
+// The volumes are sorted by prefix, so that the file does not depend
+// on the order in which they were produced and the reader can look
+// them up by binary search.  The file is written atomically and only
+// if its contents changed (see OutputFile.hh); returns true if it was
+// (re)written.
+//
+
+// Utilities includes
+#include "Utilities/inc/SimpleConfigVolume.hh"
+
+// C++ includes
+#include <string>
+#include <vector>
+
+namespace util {
+
+  bool writeBinaryGeometry( const std::string& filename, std::vector<SimpleConfigVolume> volumes );
+
+} // end of namespace util
+
+#endif /* util_BinaryGeometryWriter_hh */
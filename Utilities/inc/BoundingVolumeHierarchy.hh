@@ -0,0 +1,112 @@
+#ifndef util_BoundingVolumeHierarchy_hh
+#define util_BoundingVolumeHierarchy_hh
+//
+// Bounding-volume hierarchy over axis-aligned boxes, for finding the
+// volumes near a point or another volume without testing all of them.
+//
+// The boxes are given once; the tree is built top-down by splitting
+// each node at the median of its longest axis (box centres), down to
+// leaves of at most leafSize boxes.  Queries report the indices of
+// the boxes that overlap the query box with a positive extent on every
+// axis, so boxes that merely touch are not reported.
+//
+
+// C++ includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace util {
+
+  class BoundingVolumeHierarchy {
+
+  public:
+
+    struct Box {
+      std::array<double,3> min;
+      std::array<double,3> max;
+
+      bool overlaps( const Box& other ) const {
+        for ( std::size_t k(0) ; k < 3 ; ++k )
+          if ( !( min[k] < other.max[k] && other.min[k] < max[k] ) ) return false;
+        return true;
+      }
+
+      bool contains( const std::array<double,3>& point ) const {
+        for ( std::size_t k(0) ; k < 3 ; ++k )
+          if ( !( min[k] <= point[k] && point[k] <= max[k] ) ) return false;
+        return true;
+      }
+    };
+
+    static constexpr std::size_t leafSize = 4;
+
+    explicit BoundingVolumeHierarchy( std::vector<Box> boxes );
+
+    std::size_t size()                 const { return boxes_.size(); }
+    const Box&  box( std::size_t i )   const { return boxes_[i]; }
+
+    // Calls f(i) for every box i that overlaps the query box
+    template <typename F>
+    void query( const Box& box, F&& f ) const {
+      visit( [&]( const Box& node ){ return node.overlaps( box ); },
+             [&]( std::size_t i ){ if ( boxes_[i].overlaps( box ) ) f( i ); } );
+    }
+
+    // Calls f(i) for every box i that contains the point
+    template <typename F>
+    void query( const std::array<double,3>& point, F&& f ) const {
+      visit( [&]( const Box& node ){ return node.contains( point ); },
+             [&]( std::size_t i ){ if ( boxes_[i].contains( point ) ) f( i ); } );
+    }
+
+    // Calls f(i,j), i < j, once for every pair of overlapping boxes
+    template <typename F>
+    void overlappingPairs( F&& f ) const {
+      for ( std::size_t i(0) ; i < boxes_.size() ; ++i ) {
+        query( boxes_[i], [&]( std::size_t j ){ if ( i < j ) f( i, j ); } );
+      }
+    }
+
+  private:
+
+    struct Node {
+      Box           box;
+      std::uint32_t first;   // leaf: first entry in items_, else index of the left child
+      std::uint32_t count;   // leaf: number of boxes, 0 for an inner node
+    };
+
+    std::vector<Box>           boxes_;
+    std::vector<std::uint32_t> items_;
+    std::vector<Node>          nodes_;
+
+    // Fills node with the boxes items_[begin,end), splitting it if needed
+    void build( std::uint32_t node, std::uint32_t begin, std::uint32_t end );
+
+    // Depth-first walk of the nodes for which enter(node box) is true,
+    // calling leaf(i) for the boxes in their leaves
+    template <typename Enter, typename Leaf>
+    void visit( Enter&& enter, Leaf&& leaf ) const {
+      if ( nodes_.empty() ) return;
+      std::uint32_t stack[64];
+      std::size_t   depth(0);
+      stack[depth++] = 0;
+      while ( depth > 0 ) {
+        const Node& node = nodes_[ stack[--depth] ];
+        if ( !enter( node.box ) ) continue;
+        if ( node.count > 0 ) {
+          for ( std::uint32_t k = node.first ; k < node.first+node.count ; ++k ) leaf( items_[k] );
+        }
+        else {
+          stack[depth++] = node.first;
+          stack[depth++] = node.first+1;
+        }
+      }
+    }
+
+  };
+
+} // end of namespace util
+
+#endif /* util_BoundingVolumeHierarchy_hh */
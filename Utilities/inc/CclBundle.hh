@@ -0,0 +1,74 @@
+#ifndef util_CclBundle_hh
+#define util_CclBundle_hh
+//
+// Many .ccl files in one file, read with one open and one mapping.
+//
+// A bundle (conventionally *.cclb) is the .ccl files one after the
+// other, each preceded by an entry naming it:
+//
+//   File)geom_DSarea.ccl
+//   VolName)dsArea
+//   Height)0:-6,11:4
+//   *)0,0
+//   ...
+//   File)geom_PSarea.ccl
+//   VolName)psArea
+//   ...
+//
+// The text of a volume is everything between its File) line and the
+// next, so splitting a bundle gives back the files it was made of.
+// Names are plain file names (no directories) without whitespace, and
+// each appears once; a coordinate of a bundled file cannot be labelled
+// "File".
+//
+
+// Utilities includes
+#include "Utilities/inc/MappedFile.hh"
+
+// C++ includes
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace util {
+
+  class CclBundle {
+
+  public:
+
+    // One .ccl file of the bundle; views into the mapping
+    struct Volume {
+      std::string_view name;
+      std::string_view text;
+    };
+
+    static constexpr std::string_view marker    = "File)";
+    static constexpr std::string_view extension = ".cclb";
+
+    static bool isBundle( std::string_view filename ) { return filename.ends_with( extension ); }
+
+    // Throws if the file does not start with a File) entry, or if a
+    // name is empty, has a '/' or whitespace, or is repeated
+    explicit CclBundle( const std::string& filename );
+
+    const std::string&       filename() const { return file_.filename(); }
+    std::span<const Volume>  volumes()  const { return volumes_; }
+
+  private:
+
+    MappedFile          file_;
+    std::vector<Volume> volumes_;
+
+  };
+
+  // Writes the .ccl files (named by their file name) to one bundle;
+  // throws if a file name has whitespace
+  void writeCclBundle( std::span<const std::string> cclFiles, const std::string& bundle );
+
+  // Writes each volume of the bundle to directory/name (if changed)
+  void splitCclBundle( const std::string& bundle, const std::string& directory );
+
+} // end of namespace util
+
+#endif /* util_CclBundle_hh */
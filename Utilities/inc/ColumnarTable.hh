@@ -0,0 +1,332 @@
+#ifndef util_ColumnarTable_hh
+#define util_ColumnarTable_hh
+//
+// Loading of large tables (e.g. tabulated spectra) into columns.
+//
+// The file has the format read by loadTable<N>: a key and N-1 numbers
+// per row, separated by whitespace, except that each row must be on
+// one line (blank lines are skipped).  loadColumnarTable<N> maps the
+// file, splits it into chunks that end at line boundaries and parses
+// the chunks on nThreads threads (0 means one per core) with
+// std::from_chars.  The keys are stored one after the other with their
+// offsets, and each of the N-1 value columns is one contiguous array.
+// The result does not depend on the number of threads.
+//
+// If cacheFile is given, the parsed table is also written to it in a
+// binary form that is used by mapping it, without parsing or copying,
+// as long as the size and modification time of the table file match
+// those recorded in it.  Otherwise the table is parsed again and the
+// cache rewritten.  An unwritable cache is ignored.
+//
+// Cache layout (version 1), numbers in the byte order of the machine
+// that wrote it:
+//
+//   CacheHeader
+//   values[N-1][nRows]      (double, column after column)
+//   keyOffsets[nRows+1]     (uint64, offsets of the keys in the key bytes)
+//   key bytes
+//
+
+// Utilities includes
+#include "Utilities/inc/MappedFile.hh"
+#include "Utilities/inc/OutputFile.hh"
+#include "Utilities/inc/Table.hh"
+#include "Utilities/inc/parallelFor.hh"
+
+// C++ includes
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// POSIX includes
+#include <sys/stat.h>
+
+namespace util {
+
+  namespace columnarTable {
+
+    constexpr char          magic[8]  = { 'M','U','2','E','T','A','B','L' };
+    constexpr std::uint32_t version   = 1;
+    constexpr std::uint32_t endianTag = 0x01020304;
+
+    // Chunks are at least this large, so that small tables are parsed
+    // by one thread
+    constexpr std::size_t minChunkSize = 1 << 20;
+
+    struct CacheHeader {
+      char          magic[8];
+      std::uint32_t version;
+      std::uint32_t endianTag;
+      std::uint32_t nColumns;
+      std::uint32_t reserved;
+      std::uint64_t nRows;
+      std::uint64_t keyBytes;
+      std::uint64_t sourceSize;
+      std::int64_t  sourceMtime;    // ns
+    };
+
+    static_assert( sizeof(CacheHeader) == 56, "unexpected padding in CacheHeader" );
+
+    // What identifies the version of the table file a cache was made from
+    struct SourceStamp {
+      std::uint64_t size;
+      std::int64_t  mtime;
+    };
+
+    inline SourceStamp sourceStamp( const std::string& tableFile ) {
+      struct stat info;
+      if ( ::stat( tableFile.c_str(), &info ) != 0 )
+        throw std::runtime_error( "Cannot stat table file: "+tableFile+" ("+std::strerror(errno)+")" );
+      return { std::uint64_t( info.st_size ), std::int64_t( info.st_mtim.tv_sec )*1000000000+info.st_mtim.tv_nsec };
+    }
+
+    inline bool isBlank( char c ) { return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f'; }
+
+    // The rows of one chunk, before they are placed in the columns
+    struct Chunk {
+      std::string                keys;
+      std::vector<std::uint64_t> keyEnds;
+      std::vector<double>        values;   // row after row
+    };
+
+    [[noreturn]] inline void parseError( std::string_view text, const char* where, const std::string& tableFile, const std::string& what ) {
+      const std::size_t line = 1+std::count( text.data(), where, '\n' );
+      throw std::runtime_error( what+" in table file "+tableFile+", line "+std::to_string( line ) );
+    }
+
+    // Parses the lines of text[begin,end), which starts at a line
+    inline void parseChunk( std::string_view text, std::size_t begin, std::size_t end, unsigned nValues,
+                            const std::string& tableFile, Chunk& chunk ) {
+      const char* p    = text.data()+begin;
+      const char* last = text.data()+end;
+      while ( p < last ) {
+        const char* eol = static_cast<const char*>( std::memchr( p, '\n', last-p ) );
+        if ( eol == nullptr ) eol = last;
+
+        while ( p < eol && isBlank( *p ) ) ++p;
+        if ( p == eol ) { p = eol+1; continue; }
+
+        const char* key = p;
+        while ( p < eol && !isBlank( *p ) ) ++p;
+        chunk.keys.append( key, p );
+        chunk.keyEnds.push_back( chunk.keys.size() );
+
+        for ( unsigned j(0) ; j < nValues ; ++j ) {
+          while ( p < eol && isBlank( *p ) ) ++p;
+          if ( p == eol ) parseError( text, p, tableFile, "Missing values" );
+          if ( *p == '+' ) ++p;   // accepted by operator>>, not by from_chars
+          double value;
+          const auto result = std::from_chars( p, eol, value );
+          if ( result.ec != std::errc() || ( result.ptr != eol && !isBlank( *result.ptr ) ) )
+            parseError( text, p, tableFile, "Invalid number" );
+          chunk.values.push_back( value );
+          p = result.ptr;
+        }
+
+        while ( p < eol && isBlank( *p ) ) ++p;
+        if ( p != eol ) parseError( text, p, tableFile, "Too many values" );
+        p = eol+1;
+      }
+    }
+
+  }
+
+  template <const unsigned N> class ColumnarTable {
+
+    static_assert( N >= 1, "a table has at least the key column" );
+
+  public:
+
+    ColumnarTable( ColumnarTable&& ) = default;
+    ColumnarTable& operator=( ColumnarTable&& ) = default;
+
+    // The views point into the owned arrays or the mapping
+    ColumnarTable( const ColumnarTable& ) = delete;
+    ColumnarTable& operator=( const ColumnarTable& ) = delete;
+
+    unsigned getNrows() const { return nRows_; }
+    unsigned getNcols() const { return N; }
+
+    std::string_view key( unsigned i ) const {
+      return { keys_+keyOffsets_[i], std::size_t( keyOffsets_[i+1]-keyOffsets_[i] ) };
+    }
+
+    // Column j of the values, i.e. column j+1 of the file
+    std::span<const double> column( unsigned j ) const { return { values_+std::size_t(j)*nRows_, nRows_ }; }
+
+    double value( unsigned i, unsigned j ) const { return values_[std::size_t(j)*nRows_+i]; }
+
+    // Row i as loadTable<N> stores it
+    TableRow<N> getRow( unsigned i ) const {
+      TableRow<N> row;
+      row.first = key( i );
+      for ( unsigned j(0) ; j < N-1 ; ++j ) row.second[j] = value( i, j );
+      return row;
+    }
+
+    // True if the table was mapped from the cache rather than parsed
+    bool fromCache() const { return cache_.has_value(); }
+
+  private:
+
+    ColumnarTable() = default;
+
+    std::size_t nRows_ = 0;
+
+    // Parsed tables own their arrays, cached ones are views into the cache
+    std::vector<char>          ownedKeys_;
+    std::vector<std::uint64_t> ownedKeyOffsets_;
+    std::vector<double>        ownedValues_;
+    std::optional<MappedFile>  cache_;
+
+    const char*          keys_       = nullptr;
+    const std::uint64_t* keyOffsets_ = nullptr;
+    const double*        values_     = nullptr;
+
+    static std::optional<ColumnarTable> mapCache( const std::string& cacheFile, const columnarTable::SourceStamp& stamp );
+    static ColumnarTable parse( const std::string& tableFile, unsigned nThreads );
+    void writeCache( const std::string& cacheFile, const columnarTable::SourceStamp& stamp ) const;
+
+    template <const unsigned M>
+    friend ColumnarTable<M> loadColumnarTable( const std::string& tableFile, unsigned nThreads, const std::string& cacheFile );
+
+  };
+
+  //====================================================================================
+  template <const unsigned N>
+  std::optional<ColumnarTable<N>> ColumnarTable<N>::mapCache( const std::string& cacheFile, const columnarTable::SourceStamp& stamp ) {
+
+    using namespace columnarTable;
+
+    struct stat info;
+    if ( ::stat( cacheFile.c_str(), &info ) != 0 ) return std::nullopt;
+
+    MappedFile file( cacheFile );
+    if ( file.size() < sizeof(CacheHeader) ) return std::nullopt;
+    CacheHeader h;
+    std::memcpy( &h, file.contents().data(), sizeof(h) );
+    if ( std::memcmp( h.magic, magic, sizeof(h.magic) ) != 0 || h.version != version || h.endianTag != endianTag ||
+         h.nColumns != N || h.sourceSize != stamp.size || h.sourceMtime != stamp.mtime ) return std::nullopt;
+    if ( file.size() != sizeof(CacheHeader)+( h.nRows*(N-1)+h.nRows+1 )*8+h.keyBytes ) return std::nullopt;
+
+    ColumnarTable table;
+    const char* data   = file.contents().data();
+    table.nRows_       = h.nRows;
+    table.values_      = reinterpret_cast<const double*>( data+sizeof(CacheHeader) );
+    table.keyOffsets_  = reinterpret_cast<const std::uint64_t*>( table.values_+h.nRows*(N-1) );
+    table.keys_        = reinterpret_cast<const char*>( table.keyOffsets_+h.nRows+1 );
+    if ( table.keyOffsets_[0] != 0 || table.keyOffsets_[h.nRows] != h.keyBytes ) return std::nullopt;
+    table.cache_.emplace( std::move( file ) );
+    return table;
+  }
+
+  //====================================================================================
+  template <const unsigned N>
+  ColumnarTable<N> ColumnarTable<N>::parse( const std::string& tableFile, unsigned nThreads ) {
+
+    using namespace columnarTable;
+
+    const MappedFile       file( tableFile );
+    const std::string_view text = file.contents();
+
+    // Chunk boundaries, moved forward to the start of a line
+    const std::size_t nChunks = resolveThreadCount( nThreads, std::max<std::size_t>( 1, text.size()/minChunkSize ) );
+    std::vector<std::size_t> bounds( nChunks+1, text.size() );
+    bounds[0] = 0;
+    for ( std::size_t k(1) ; k < nChunks ; ++k ) {
+      std::size_t bound = std::max( bounds[k-1], k*text.size()/nChunks );
+      while ( bound < text.size() && bound > 0 && text[bound-1] != '\n' ) ++bound;
+      bounds[k] = bound;
+    }
+
+    std::vector<Chunk> chunks( nChunks );
+    parallelFor( nChunks, nChunks, [&]( std::size_t k ){
+        parseChunk( text, bounds[k], bounds[k+1], N-1, tableFile, chunks[k] );
+      } );
+
+    // Place the rows of each chunk in the columns
+    std::vector<std::size_t> firstRow( nChunks+1, 0 ), firstKeyByte( nChunks+1, 0 );
+    for ( std::size_t k(0) ; k < nChunks ; ++k ) {
+      firstRow    [k+1] = firstRow    [k]+chunks[k].keyEnds.size();
+      firstKeyByte[k+1] = firstKeyByte[k]+chunks[k].keys.size();
+    }
+
+    ColumnarTable table;
+    const std::size_t nRows = firstRow[nChunks];
+    table.nRows_ = nRows;
+    table.ownedKeys_      .resize( firstKeyByte[nChunks] );
+    table.ownedKeyOffsets_.resize( nRows+1 );
+    table.ownedValues_    .resize( nRows*(N-1) );
+    table.ownedKeyOffsets_[nRows] = firstKeyByte[nChunks];
+
+    parallelFor( nChunks, nChunks, [&]( std::size_t k ){
+        const Chunk& chunk = chunks[k];
+        std::copy( chunk.keys.begin(), chunk.keys.end(), table.ownedKeys_.begin()+firstKeyByte[k] );
+        for ( std::size_t i(0) ; i < chunk.keyEnds.size() ; ++i ) {
+          const std::size_t row = firstRow[k]+i;
+          table.ownedKeyOffsets_[row] = firstKeyByte[k]+( i == 0 ? 0 : chunk.keyEnds[i-1] );
+          for ( unsigned j(0) ; j < N-1 ; ++j ) table.ownedValues_[j*nRows+row] = chunk.values[i*(N-1)+j];
+        }
+      } );
+
+    table.keys_       = table.ownedKeys_.data();
+    table.keyOffsets_ = table.ownedKeyOffsets_.data();
+    table.values_     = table.ownedValues_.data();
+    return table;
+  }
+
+  //====================================================================================
+  template <const unsigned N>
+  void ColumnarTable<N>::writeCache( const std::string& cacheFile, const columnarTable::SourceStamp& stamp ) const {
+
+    using namespace columnarTable;
+
+    CacheHeader h;
+    std::memset( &h, 0, sizeof(h) );
+    std::memcpy( h.magic, magic, sizeof(h.magic) );
+    h.version     = version;
+    h.endianTag   = endianTag;
+    h.nColumns    = N;
+    h.nRows       = nRows_;
+    h.keyBytes    = keyOffsets_[nRows_];
+    h.sourceSize  = stamp.size;
+    h.sourceMtime = stamp.mtime;
+
+    std::string buffer;
+    buffer.reserve( sizeof(h)+( nRows_*N+1 )*8+h.keyBytes );
+    buffer.append( reinterpret_cast<const char*>( &h ), sizeof(h) );
+    buffer.append( reinterpret_cast<const char*>( values_ ), nRows_*(N-1)*sizeof(double) );
+    buffer.append( reinterpret_cast<const char*>( keyOffsets_ ), ( nRows_+1 )*sizeof(std::uint64_t) );
+    buffer.append( keys_, h.keyBytes );
+
+    // An unwritable cache (e.g. a read-only directory) only costs the
+    // next load a parse
+    try { writeAtomically( cacheFile, buffer ); }
+    catch ( const std::exception& ) {}
+  }
+
+  //-------------- free function, friend to ColumnarTable class ------------------------------------------------
+  template <const unsigned N>
+  ColumnarTable<N> loadColumnarTable( const std::string& tableFile, unsigned nThreads = 0, const std::string& cacheFile = "" ) {
+
+    if ( cacheFile.empty() ) return ColumnarTable<N>::parse( tableFile, nThreads );
+
+    const columnarTable::SourceStamp stamp = columnarTable::sourceStamp( tableFile );
+    if ( auto cached = ColumnarTable<N>::mapCache( cacheFile, stamp ) ) return std::move( *cached );
+
+    ColumnarTable<N> table = ColumnarTable<N>::parse( tableFile, nThreads );
+    table.writeCache( cacheFile, stamp );
+    return table;
+  }
+
+} // end of namespace util
+
+#endif /* util_ColumnarTable_hh */
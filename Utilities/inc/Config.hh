@@ -14,6 +14,9 @@ namespace util {
 
     std::vector<std::string> bldgPrefixes;
     std::vector<std::string> dirtPrefixes;
+
+    // SimpleConfig files written on disk (not part of mu2eBuilding.txt)
+    std::vector<std::string> outputFiles;
   };
 }
 
@@ -0,0 +1,50 @@
+#ifndef util_ConvexDecomposition_hh
+#define util_ConvexDecomposition_hh
+//
+// Decomposition of a simple polygon into convex pieces, for volumes
+// whose concave extrusions are slow to navigate.
+//
+// The polygon (either orientation; vertices collinear with their
+// neighbours are dropped first) is triangulated by ear clipping, and
+// the diagonals are then removed, longest first, whenever both of
+// their end points stay convex (Hertel-Mehlhorn).  The result has at
+// most four times the minimal number of pieces, and in practice is
+// close to it: a polygon with r reflex vertices needs at least
+// ceil(r/2)+1 pieces and gets at most 2r+1.
+//
+// The cost estimates model G4ExtrudedSolid for a right prism: a convex
+// one is tested against its n side planes and two caps (n+2 tests),
+// while a concave one falls back to its tessellated surface of n side
+// and 2(n-2) cap facets (3n-4 tests).  After decomposition the
+// navigator's voxels select the piece a point is in, so the expected
+// cost is the mean cost of the pieces weighted by their areas; the sum
+// over the pieces is the worst case of testing them all.
+//
+
+// Utilities includes
+#include "Utilities/inc/PolygonBoolean.hh"
+
+// C++ includes
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace util {
+
+  struct ConvexDecomposition {
+    std::vector<Polygon> pieces;        // counter-clockwise; one if already convex
+    std::size_t          vertices = 0;  // after dropping collinear ones
+    std::size_t          reflex   = 0;  // number of reflex vertices
+
+    double cost     = 0.;   // estimated tests per point, of the polygon
+    double meanCost = 0.;   // of the pieces, weighted by their areas
+    double sumCost  = 0.;   // of all pieces
+  };
+
+  // An empty list of pieces means that the polygon could not be
+  // triangulated (it is not simple)
+  ConvexDecomposition decomposeConvex( std::span<const double> x, std::span<const double> y );
+
+} // end of namespace util
+
+#endif /* util_ConvexDecomposition_hh */
@@ -9,6 +9,7 @@
 #include <array>
 #include <iostream>
 #include <sstream>
+#include <string_view>
 #include <utility>
 
 namespace worldDir {
@@ -81,8 +82,11 @@ namespace util {
     typedef std::pair <int,double> FtInchPair;
     template <typename T> using Rep = std::array<T,2>;
 
-    // Constructors
-    explicit Coordinate( const std::string& input );
+    // Constructors.  The line is parsed by parseCoordinate, which does
+    // not allocate, but the Coordinate keeps copies of the line, its
+    // label and its reference label; only those that do not fit in the
+    // small-string buffer (typically the line) cost an allocation.
+    explicit Coordinate( std::string_view input );
 
     explicit Coordinate( const Rep<double>& point,
                          const std::string& label,
@@ -131,7 +135,6 @@ namespace util {
     std::string inputString_;
 
     std::string label_;
-    std::string coordStr_;
     std::string refLabel_;
     double      rotWrtRef_;
 
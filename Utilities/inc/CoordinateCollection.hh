@@ -6,16 +6,23 @@
 
 // Utilities includes
 #include "Utilities/inc/Coordinate.hh"
+#include "Utilities/inc/SimpleConfigVolume.hh"
 
 // C++ includes
+#include <cstdint>
+#include <functional>
 #include <map>
-#include <set>
+#include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace util {
 
+  class AnchorRegistry;
   class Config;
+  class TextBuffer;
 
   class CoordinateCollection {
 
@@ -23,20 +30,73 @@ namespace util {
 
     template <typename T> using Rep = Coordinate::Rep<T>;
 
-    // Constructors
+    // Per-vertex flags (bit mask), see vertexFlags()
+    enum VertexFlag : std::uint8_t {
+      Draw     = 1,   // drawn (label not commented out with "//")
+      Outline  = 2,   // on the outer outline (lowercase label)
+      Boundary = 4    // snapped to a world wall ("[N]", "[E]", ...)
+    };
+
+    // A polygon as contiguous x and y arrays; index holds the position
+    // of each vertex in coordinates()
+    struct PolygonView {
+      std::span<const double>      x;
+      std::span<const double>      y;
+      std::span<const std::size_t> index;
+
+      std::size_t size() const { return x.size(); }
+    };
+
+    // Constructors; references "<@label>" are looked up in anchors,
+    // which must outlive the constructor call only.  With fixedPoint,
+    // positions reached through exact lengths and rotations by multiples
+    // of 90 degrees are resolved in integer units (see FixedLength.hh)
+    // and converted to mm once.
     explicit CoordinateCollection( const std::string& inputCollection,
-                                   const std::map<worldDir::enum_type,Coordinate::Rep<double>>& worldCorners);
+                                   const std::map<worldDir::enum_type,Coordinate::Rep<double>>& worldCorners,
+                                   const AnchorRegistry* anchors = nullptr,
+                                   const bool fixedPoint = false );
+
+    // The same from the text of a .ccl file that is already in memory
+    // (e.g. a volume of a CclBundle); source names it in error messages
+    // and in the SimpleConfig file
+    CoordinateCollection( std::string_view text,
+                          const std::string& source,
+                          const std::map<worldDir::enum_type,Coordinate::Rep<double>>& worldCorners,
+                          const AnchorRegistry* anchors = nullptr,
+                          const bool fixedPoint = false );
 
     const std::string&             volName()     const { return volName_;   }
 
     const std::vector<Coordinate>& coordinates() const { return coordList_; }
     const Rep<double>&             height()      const { return height_;    }
 
+    // Resolved positions (mm) and flags of all coordinates, in the
+    // order of coordinates()
+    std::span<const double>        xPositions()  const { return x_;     }
+    std::span<const double>        yPositions()  const { return y_;     }
+    std::span<const std::uint8_t>  vertexFlags() const { return flags_; }
+
+    // The polygon handed to ROOT and written out: all drawn vertices
+    // but the first (reference) one, and the subset of those that lie
+    // on the outline
+    PolygonView drawnPolygon()   const { return drawn_  .view(); }
+    PolygonView outlinePolygon() const { return outline_.view(); }
+
     const Rep<double>& worldCorner(worldDir::enum_type i) const {
       return worldCorners_.find(i)->second;
     }
 
-    void printSimpleConfigFile( Config& config, std::string const & dir, const bool outline = false ) const;
+    // The parameters of the SimpleConfig file of the volume, of the
+    // drawn polygon or (outline = true) of the outline
+    SimpleConfigVolume simpleConfigVolume( const bool outline = false ) const;
+
+    // Writes the SimpleConfig file and returns what it holds
+    SimpleConfigVolume printSimpleConfigFile( Config& config, std::string const & dir, const bool outline = false ) const;
+
+    // Appends the contents of that file for volume (as returned by
+    // simpleConfigVolume) to fs, without writing it
+    void formatSimpleConfigFile( TextBuffer& fs, const SimpleConfigVolume& volume, const bool outline = false ) const;
 
     void setName( const std::string& name ) { volName_ = name; }
     bool addWorldBoundaries(const bool verbose = false );
@@ -51,20 +111,51 @@ namespace util {
   private:
 
     std::string inputFile_;
+    bool        fixedPoint_;
     std::map<worldDir::enum_type,Rep<double>> worldCorners_;
 
     std::string volName_;
 
-    std::set<std::string> keyList_;
+    // Index in coordList_ of every label, for O(1) reference lookup
+    std::unordered_map<std::string,std::size_t> labelIndex_;
     std::vector<Coordinate>  coordList_;
     std::vector<Coordinate>  boundaryList_;
     Rep<double> height_;
 
-    std::string assignVolName( const std::string& inputString );
-    Rep<double> assignHeight ( const std::string& inputString );
-    void check_and_push_back( Coordinate& coordStr );
+    struct Polygon {
+      std::vector<double>      x;
+      std::vector<double>      y;
+      std::vector<std::size_t> index;
+
+      PolygonView view() const { return { x, y, index }; }
+    };
+
+    // Structure-of-arrays copy of coordList_, kept in step by indexVertex
+    std::vector<double>       x_;
+    std::vector<double>       y_;
+    std::vector<std::uint8_t> flags_;
+    Polygon                   drawn_;
+    Polygon                   outline_;
+
+    // Parses the entries returned by next and resolves the positions
+    void construct( const std::function<bool(std::string_view&)>& next, const AnchorRegistry* anchors );
+
+    void appendVertex( Coordinate&& coord );
+    void indexVertex ( std::size_t i );
+
+    std::string assignVolName( std::string_view inputString );
+    Rep<double> assignHeight ( std::string_view inputString );
+    // Checks the labels, fills in the inherited reference and rotation
+    // and appends the index of the reference coordinate to refIndex.
+    // An anchor referred to for the first time is added just before
+    // the coordinate, as an undrawn point that is its own reference.
+    void check_and_push_back( Coordinate&& coordStr, std::vector<std::size_t>& refIndex, const AnchorRegistry* anchors );
+
+    std::size_t getReferenceIndex( const std::string& refLabel ) const;
 
-    Coordinate getReferenceCoordinate( const std::string& refLabel ) const;
+    // Computes the absolute positions, one (reference, rotation) frame
+    // at a time, and fills the per-vertex arrays
+    void resolvePositions( const std::vector<std::size_t>& refIndex, const AnchorRegistry* anchors );
 
     Coordinate getWallCoordinate     ( const Coordinate& c1, const std::string& label ) const;
     Coordinate getCornerCoordinate   ( const worldDir::enum_type type1, const worldDir::enum_type type2 ) const;
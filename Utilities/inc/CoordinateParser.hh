@@ -0,0 +1,57 @@
+#ifndef util_CoordinateParser_hh
+#define util_CoordinateParser_hh
+//
+// Single-pass parser for one coordinate line of a .ccl file, of the form
+//
+//   B)[N]<A|14>xFt:xIn,yFt:yIn
+//
+// where "B" is the label (prefixed by "//" if the point is not to be
+// drawn, and lowercase if it lies on the outline), "[N]" the optional
+// world-wall snap, "A" the optional reference label and "14" the
+// optional rotation in degrees.  Each of the ordered-pair components
+// is "ft", "ft:in" or ":in"; empty fields are zero.
+//
+// The parser works on a std::string_view, never allocates (except to
+// build the message of an exception), and converts numbers with
+// std::from_chars, so it does not depend on the locale.  The views in
+// ParsedCoordinate point into the parsed line and are only valid as
+// long as it is.  A Coordinate built from a line copies the strings it
+// keeps (see Coordinate.hh), so constructing one may allocate.
+//
+// Malformed lines throw std::runtime_error; the message contains the
+// (1-based) column at which the problem was found.
+//
+
+// Utilities includes
+#include "Utilities/inc/Coordinate.hh"
+
+// C++ includes
+#include <string_view>
+
+namespace util {
+
+  struct ParsedCoordinate {
+    std::string_view label;
+    std::string_view refLabel;        // empty if inherited from previous coordinate
+    std::string_view coordStr;        // the "x,y" part
+
+    bool   hasRotation   = false;     // false if inherited from previous coordinate
+    double rotation      = 0.;
+    bool   draw          = true;
+    bool   isOut         = false;
+    worldDir::enum_type worldBoundary = worldDir::none;
+
+    Coordinate::Rep<Coordinate::FtInchPair> coordStd {};
+  };
+
+  void parseCoordinate( std::string_view line, ParsedCoordinate& result );
+
+  // Parses "ft", "ft:in" or ":in"; column is the 1-based column of the
+  // first character of text, used for error messages
+  Coordinate::FtInchPair parseFtInchPair( std::string_view text,
+                                          std::string_view line,
+                                          std::size_t column );
+
+} // end of namespace util
+
+#endif /* util_CoordinateParser_hh */
@@ -0,0 +1,68 @@
+#ifndef util_DirectoryWatcher_hh
+#define util_DirectoryWatcher_hh
+//
+// Notification of changes to the files of one directory (Linux inotify).
+//
+// wait() blocks until at least one file whose name ends in the given
+// suffix has been written and closed, moved into the directory (as
+// editors that save through a temporary file do), moved out of it or
+// deleted.  Events arriving within a few milliseconds of each other
+// are collected into one batch, so that a save, which may touch a file
+// more than once, is reported once.
+//
+// The names returned are the directory name joined with the file name.
+// A file is reported as modified if it exists when the batch is
+// returned and as removed otherwise.
+//
+// watchFile() adds one more file, in any directory and with any name
+// (e.g. the anchors file); it is reported by the path it was given.
+//
+
+// C++ includes
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+  class DirectoryWatcher {
+
+  public:
+
+    struct Changes {
+      std::vector<std::string> modified;
+      std::vector<std::string> removed;
+    };
+
+    DirectoryWatcher( const std::string& directory, const std::string& suffix );
+    ~DirectoryWatcher();
+
+    DirectoryWatcher( const DirectoryWatcher& ) = delete;
+    DirectoryWatcher& operator=( const DirectoryWatcher& ) = delete;
+
+    Changes wait();
+
+    // Also reports changes to file, given as a path
+    void watchFile( const std::string& file );
+
+    // The files with the suffix currently in the directory, sorted
+    std::vector<std::string> files() const;
+
+  private:
+
+    std::string directory_;
+    std::string suffix_;
+    int         fd_;
+    int         watch_;
+
+    // (watch descriptor, file name) -> path of the files of watchFile()
+    std::map<std::pair<int,std::string>,std::string> files_;
+
+    std::string path( const std::string& name ) const;
+
+  };
+
+} // end of namespace util
+
+#endif /* util_DirectoryWatcher_hh */
@@ -0,0 +1,50 @@
+#ifndef util_DirtComplement_hh
+#define util_DirtComplement_hh
+//
+// Replacement of the dirt volumes by few simple ones.
+//
+// The dirt of each .ccl file (inferred from its outline or given
+// explicitly) is a volume of its own, so the dirt volumes are many,
+// mostly concave, and their number grows with the number of files.
+// The replacement covers the same region without overlaps.  Here the
+// heights at which any volume starts or ends cut the hall into slabs;
+// in each slab the dirt is the region covered by the footprint of a
+// dirt volume spanning the slab, minus the footprints of the building
+// volumes spanning it (polygonDifference), split into few simple
+// polygons.  Building interiors are not volumes, so the dirt is not
+// extended beyond the dirt volumes into the world box.  A polygon that
+// is identical in consecutive slabs becomes one taller volume, and
+// pieces of up to 1 mm^2 (rounding slivers) are dropped.
+//
+// All volumes are taken in the frame of the first dirt volume (their
+// offsets are shifted to it), and the result has its offsets and
+// material.  Vertices on the world boundary (x = +-worldX, y =
+// +-worldY in the polygon frame) are listed in xReplace/yReplace.
+//
+
+// Utilities includes
+#include "Utilities/inc/Config.hh"
+#include "Utilities/inc/SimpleConfigVolume.hh"
+
+// C++ includes
+#include <span>
+#include <string>
+#include <vector>
+
+namespace util {
+
+  // Named dirt.complement.slabK.partI, for part I starting in slab K
+  std::vector<SimpleConfigVolume> dirtComplement( std::span<const SimpleConfigVolume> buildings,
+                                                  std::span<const SimpleConfigVolume> dirt,
+                                                  double worldX, double worldY );
+
+  // The lines the SimpleConfig file of a complement volume starts with
+  std::string dirtComplementComment( const SimpleConfigVolume& volume );
+
+  // Writes the SimpleConfig file of each volume to dir (if changed) and
+  // adds it to the dirt lists of config
+  void printDirtComplement( std::span<const SimpleConfigVolume> volumes, Config& config, const std::string& dir );
+
+} // end of namespace util
+
+#endif /* util_DirtComplement_hh */
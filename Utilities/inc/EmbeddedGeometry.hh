@@ -0,0 +1,159 @@
+#ifndef util_EmbeddedGeometry_hh
+#define util_EmbeddedGeometry_hh
+//
+// All resolved volumes compiled into a program, and their accessors.
+//
+// ProduceSimpleConfig --embed geometry.hh writes a header that defines
+//
+//   namespace mu2eHall {
+//     inline constexpr util::EmbeddedGeometry<nVolumes,nVertices,nXReplace,nYReplace> geometry = { ... };
+//   }
+//
+// with the information of the SimpleConfig files (see
+// SimpleConfigVolume): one record per volume, sorted by prefix, and
+// the vertices and replace indices of all volumes in shared arrays.
+// Everything is a constant expression, so a tool that includes the
+// header reads nothing at startup, and lookups by index or prefix can
+// be done at compile time:
+//
+//   constexpr auto ceiling = mu2eHall::geometry.volume( "building.dsArea.alcove1.ceiling" );
+//   static_assert( ceiling.x.size() == 4 );
+//
+// The generated header checks consistent() with a static_assert, so
+// a geometry with empty volumes or arrays that do not add up does not
+// compile.  Only this header is needed to use it.
+//
+
+// C++ includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace util {
+
+  namespace embeddedGeometry {
+
+    // One volume; its vertices are x/y[firstVertex, firstVertex+nVertices),
+    // and likewise for the replace indices
+    struct VolumeRecord {
+      std::string_view name;
+      std::string_view prefix;
+      std::string_view material;
+
+      double yMin;
+      double yMax;
+      double offsetFromMu2eOriginX;
+      double offsetFromFloorSurfaceY;
+      double offsetFromMu2eOriginZ;
+      double yHalfThickness;
+
+      std::size_t firstVertex;
+      std::size_t nVertices;
+      std::size_t firstXReplace;
+      std::size_t nXReplace;
+      std::size_t firstYReplace;
+      std::size_t nYReplace;
+    };
+
+  }
+
+  template <std::size_t NVolumes, std::size_t NVertices, std::size_t NXReplace, std::size_t NYReplace>
+  struct EmbeddedGeometry {
+
+    // The same view of a volume as BinaryGeometry::Volume
+    struct Volume {
+      std::string_view name;
+      std::string_view prefix;
+      std::string_view material;
+
+      double yMin;
+      double yMax;
+      double offsetFromMu2eOriginX;
+      double offsetFromFloorSurfaceY;
+      double offsetFromMu2eOriginZ;
+      double yHalfThickness;
+
+      std::span<const double>        x;
+      std::span<const double>        y;
+      std::span<const std::uint32_t> xReplace;
+      std::span<const std::uint32_t> yReplace;
+    };
+
+    std::array<embeddedGeometry::VolumeRecord,NVolumes> records;
+    std::array<double,NVertices>                        x;
+    std::array<double,NVertices>                        y;
+    std::array<std::uint32_t,NXReplace>                 xReplace;
+    std::array<std::uint32_t,NYReplace>                 yReplace;
+
+    static constexpr std::size_t size() { return NVolumes; }
+
+    constexpr Volume operator[]( std::size_t i ) const {
+      const embeddedGeometry::VolumeRecord& r = records[i];
+      return Volume{ r.name, r.prefix, r.material,
+                     r.yMin, r.yMax,
+                     r.offsetFromMu2eOriginX, r.offsetFromFloorSurfaceY, r.offsetFromMu2eOriginZ,
+                     r.yHalfThickness,
+                     std::span<const double>( x ).subspan( r.firstVertex, r.nVertices ),
+                     std::span<const double>( y ).subspan( r.firstVertex, r.nVertices ),
+                     std::span<const std::uint32_t>( xReplace ).subspan( r.firstXReplace, r.nXReplace ),
+                     std::span<const std::uint32_t>( yReplace ).subspan( r.firstYReplace, r.nYReplace ) };
+    }
+
+    // Index checked at compile time
+    template <std::size_t I>
+    constexpr Volume volume() const {
+      static_assert( I < NVolumes, "volume index out of range" );
+      return (*this)[I];
+    }
+
+    // Index of the volume with the given prefix (e.g. "building.dsArea"),
+    // or size() if there is none
+    constexpr std::size_t find( std::string_view prefix ) const {
+      std::size_t lo(0), hi( NVolumes );
+      while ( lo < hi ) {
+        const std::size_t mid = lo+(hi-lo)/2;
+        if ( records[mid].prefix < prefix ) lo = mid+1;
+        else hi = mid;
+      }
+      if ( lo < NVolumes && records[lo].prefix == prefix ) return lo;
+      return NVolumes;
+    }
+
+    // The volume with the given prefix; in a constant expression, a
+    // prefix that does not exist is a compile error
+    constexpr Volume volume( std::string_view prefix ) const {
+      const std::size_t i = find( prefix );
+      if ( i == NVolumes ) throw std::out_of_range( "No embedded volume with prefix "+std::string( prefix ) );
+      return (*this)[i];
+    }
+
+    // True if every volume has a name, at least 3 vertices and a
+    // positive height, the prefixes are sorted and unique, the
+    // replace indices are vertices of their volume, and the records
+    // cover the shared arrays exactly, in order
+    constexpr bool consistent() const {
+      std::size_t vertex(0), xr(0), yr(0);
+      for ( std::size_t i(0) ; i < NVolumes ; ++i ) {
+        const embeddedGeometry::VolumeRecord& r = records[i];
+        if ( r.name.empty() || r.nVertices < 3 || !( r.yMin < r.yMax ) ) return false;
+        if ( i > 0 && !( records[i-1].prefix < r.prefix ) ) return false;
+        if ( r.firstVertex != vertex || r.firstXReplace != xr || r.firstYReplace != yr ) return false;
+        if ( r.nVertices > NVertices-vertex || r.nXReplace > NXReplace-xr || r.nYReplace > NYReplace-yr ) return false;
+        for ( std::size_t j(0) ; j < r.nXReplace ; ++j ) if ( xReplace[xr+j] >= r.nVertices ) return false;
+        for ( std::size_t j(0) ; j < r.nYReplace ; ++j ) if ( yReplace[yr+j] >= r.nVertices ) return false;
+        vertex += r.nVertices;
+        xr     += r.nXReplace;
+        yr     += r.nYReplace;
+      }
+      return vertex == NVertices && xr == NXReplace && yr == NYReplace;
+    }
+
+  };
+
+} // end of namespace util
+
+#endif /* util_EmbeddedGeometry_hh */
@@ -0,0 +1,27 @@
+#ifndef util_EmbeddedGeometryWriter_hh
+#define util_EmbeddedGeometryWriter_hh
+//
+// Writing of the C++ header of all volumes read with EmbeddedGeometry.hh.
+//
+// The header defines nameSpace::geometry.  The volumes are sorted by
+// prefix as in the binary geometry file, and the numbers are written
+// in the shortest form that reads back to the same double, so the
+// compiled-in values are those of the SimpleConfig files.  The file is
+// written atomically and only if its contents changed (see
+// OutputFile.hh); returns true if it was (re)written.
+//
+
+// Utilities includes
+#include "Utilities/inc/SimpleConfigVolume.hh"
+
+// C++ includes
+#include <string>
+#include <vector>
+
+namespace util {
+
+  bool writeEmbeddedGeometry( const std::string& filename, const std::string& nameSpace, std::vector<SimpleConfigVolume> volumes );
+
+} // end of namespace util
+
+#endif /* util_EmbeddedGeometryWriter_hh */
@@ -0,0 +1,74 @@
+#ifndef util_FixedLength_hh
+#define util_FixedLength_hh
+//
+// Exact lengths, as integer multiples of 1/128000 inch.
+//
+// Converting every ft/in value to mm and summing the doubles along a
+// chain of references rounds at each step, so points that should
+// coincide across files can differ in the last digits.  The unit is
+// the least common multiple of 1/1024 and 1/1000 inch: every value of
+// the .ccl files (binary fractions and up to three decimals of an
+// inch) is a whole number of units, sums and rotations by multiples of
+// 90 degrees are exact, and the conversion to mm rounds once.  A length
+// that is not a whole number of units, and any rotation by another
+// angle, is left to the double arithmetic.
+//
+
+// Utilities includes
+#include "Utilities/inc/Coordinate.hh"
+
+// C++ includes
+#include <cmath>
+#include <cstdint>
+#include <optional>
+
+namespace util {
+
+  typedef std::int64_t FixedLength;
+
+  constexpr FixedLength fixedPerInch = 128000;
+
+  // The value of ftInch (sign convention of Coordinate::convert2mm) in
+  // units, if it is a whole number of them
+  inline std::optional<FixedLength> toFixed( const Coordinate::FtInchPair& ftInch ) {
+    if ( ftInch.first != 0 && ftInch.second < 0. ) return std::nullopt;
+    const double units   = ftInch.second*fixedPerInch;
+    const double rounded = std::round( units );
+    if ( std::abs( units-rounded ) > 1.e-6 || std::abs( rounded ) > 1.e15 ) return std::nullopt;
+    const FixedLength inches = static_cast<FixedLength>( rounded );
+    return FixedLength( ftInch.first )*12*fixedPerInch + ( ftInch.first < 0 ? -inches : inches );
+  }
+
+  inline std::optional<Coordinate::Rep<FixedLength>> toFixed( const Coordinate::Rep<Coordinate::FtInchPair>& coordStd ) {
+    const auto x = toFixed( coordStd.at(0) );
+    const auto y = toFixed( coordStd.at(1) );
+    if ( !x || !y ) return std::nullopt;
+    return Coordinate::Rep<FixedLength>{ *x, *y };
+  }
+
+  // 25.4/128000 mm = 127/640000 mm: the product is exact, the division
+  // rounds once
+  inline double fixedToMm( FixedLength length ) {
+    return double( length*127 )/640000;
+  }
+
+  // The rotation as a number of quarter turns (0-3), if it is one
+  inline std::optional<int> quarterTurns( double degrees ) {
+    const double turns = degrees/90;
+    if ( turns != std::floor( turns ) || std::abs( turns ) > 1.e6 ) return std::nullopt;
+    return ( static_cast<int>( std::fmod( turns, 4. ) )+4 )%4;
+  }
+
+  // R(quarterTurns*90 degrees)*rel, exactly
+  inline Coordinate::Rep<FixedLength> rotateFixed( const Coordinate::Rep<FixedLength>& rel, int quarterTurns ) {
+    switch ( quarterTurns ) {
+    case 1  : return { -rel.at(1),  rel.at(0) };
+    case 2  : return { -rel.at(0), -rel.at(1) };
+    case 3  : return {  rel.at(1), -rel.at(0) };
+    default : return rel;
+    }
+  }
+
+} // end of namespace util
+
+#endif /* util_FixedLength_hh */
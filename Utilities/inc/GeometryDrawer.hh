@@ -0,0 +1,56 @@
+#ifndef util_GeometryDrawer_hh
+#define util_GeometryDrawer_hh
+//
+// Drawing of the volumes with ROOT (TGeo and the OpenGL viewer).
+//
+// ROOT is only needed to draw, so it lives in a plugin,
+// Run/lib/libGeometryDrawer.so, that is loaded with dlopen when --draw
+// is given.  Without it ProduceSimpleConfig neither links nor loads any
+// ROOT library and creates no TApplication.
+//
+// The plugin exports
+//
+//   extern "C" util::GeometryDrawer* createGeometryDrawer( int* argc, char** argv,
+//                                                          double dx, double dy, double dz );
+//
+// which creates the TApplication (with the command line) and the world
+// box of half-lengths dx, dy, dz (mm).
+//
+
+// C++ includes
+#include <memory>
+#include <span>
+#include <string>
+
+namespace util {
+
+  class GeometryDrawer {
+
+  public:
+
+    // Line colour of the volume
+    enum Style { Building, Floor, Foundation, Dirt };
+
+    virtual ~GeometryDrawer() = default;
+
+    // Extrusion of the polygon from base to top (mm), placed as the
+    // volumes of Offline (polygon x/y along Mu2e z/x)
+    virtual void addVolume( const std::string& name,
+                            std::span<const double> x, std::span<const double> y,
+                            double base, double top, Style style ) = 0;
+
+    // Closes the geometry and shows it until the viewer is closed
+    virtual void draw() = 0;
+
+  };
+
+  typedef GeometryDrawer* CreateGeometryDrawer( int* argc, char** argv, double dx, double dy, double dz );
+
+  // Loads the plugin from the lib directory next to the bin directory of
+  // the executable (or, failing that, from the library path); throws if
+  // it cannot be loaded
+  std::unique_ptr<GeometryDrawer> loadGeometryDrawer( int& argc, char** argv, double dx, double dy, double dz );
+
+} // end of namespace util
+
+#endif /* util_GeometryDrawer_hh */
@@ -0,0 +1,74 @@
+#ifndef util_Manifest_hh
+#define util_Manifest_hh
+//
+// Record of which input files produced which SimpleConfig output, used
+// to skip regenerating volumes whose input has not changed.
+//
+// Each entry is keyed by the input file name and stores a content hash
+// of that file (seeded with a hash of the generator settings), together
+// with the Config lists that the file contributed to mu2eBuilding.txt
+// and the problems found by the polygon checks, which are reported
+// again when the entry is reused.  An entry is only reused if its hash
+// matches and all of its output files still exist.
+//
+// The manifest is a plain text file with one tab-separated field pair
+// per line:
+//
+//   input<TAB><hash><TAB><input file>
+//   bldgFile<TAB>#include "..."
+//   bldgPrefix<TAB>building....
+//   output<TAB>output/....txt
+//   problem<TAB>building....: edges 1 and 5 intersect (a1, b3)
+//   ...
+//
+// where every line after an "input" line belongs to that input.
+//
+
+// Utilities includes
+#include "Utilities/inc/Config.hh"
+
+// C++ includes
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace util {
+
+  // 64-bit FNV-1a hash; pass a previous result as seed to chain hashes
+  std::uint64_t hashBytes( std::string_view data, std::uint64_t seed = 0xcbf29ce484222325ULL );
+
+  class Manifest {
+
+  public:
+
+    struct Entry {
+      std::uint64_t            hash;
+      Config                   config;
+      std::vector<std::string> problems;
+    };
+
+    // Loads the manifest if the file exists, otherwise starts empty.
+    explicit Manifest( const std::string& filename );
+
+    // Returns the recorded entry for inputFile if its hash matches and
+    // all of its output files are present, nullptr otherwise.
+    const Entry* find( const std::string& inputFile, std::uint64_t hash ) const;
+
+    void update( const std::string& inputFile, const Entry& entry ) { entries_[inputFile] = entry; }
+    void erase ( const std::string& inputFile ) { entries_.erase( inputFile ); }
+
+    // Returns true if the manifest file was rewritten
+    bool write() const;
+
+  private:
+
+    std::string                  filename_;
+    std::map<std::string,Entry>  entries_;
+
+  };
+
+} // end of namespace util
+
+#endif /* util_Manifest_hh */
@@ -0,0 +1,111 @@
+#ifndef util_MappedFile_hh
+#define util_MappedFile_hh
+//
+// Read-only memory mapping of a whole file, and a reader that walks the
+// entries of a .ccl file directly in the mapped memory.
+//
+// MappedLineReader returns the same entries that loadTable<1> did: the
+// runs of non-whitespace characters, normally one per line.  Blank
+// lines and trailing whitespace are skipped, and "//" lines are
+// returned like any other entry since they describe coordinates that
+// are not drawn.  Unlike loadTable<1>, the last entry is kept even if
+// the file does not end with a newline.
+//
+// The string_views returned point into the mapping and are valid as
+// long as the MappedFile (or reader) that produced them.  EntryReader
+// walks text that is already in memory (e.g. one volume of a bundle)
+// the same way.
+//
+
+// C++ includes
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace util {
+
+  class MappedFile {
+
+  public:
+
+    explicit MappedFile( const std::string& filename );
+    ~MappedFile();
+
+    MappedFile( const MappedFile& ) = delete;
+    MappedFile& operator=( const MappedFile& ) = delete;
+
+    MappedFile( MappedFile&& other ) noexcept;
+    MappedFile& operator=( MappedFile&& other ) noexcept;
+
+    const std::string& filename() const { return filename_; }
+    std::string_view   contents() const { return { data_, size_ }; }
+    std::size_t        size()     const { return size_; }
+
+  private:
+
+    std::string filename_;
+    const char* data_;
+    std::size_t size_;
+
+    void unmap();
+
+  };
+
+  class EntryReader {
+
+  public:
+
+    explicit EntryReader( std::string_view text )
+      : text_( text )
+      , pos_(0)
+    {}
+
+    // Sets entry to the next entry and returns true, or returns false
+    // at the end of the text
+    bool next( std::string_view& entry ) {
+      while ( pos_ < text_.size() && isSpace( text_[pos_] ) ) ++pos_;
+      if ( pos_ == text_.size() ) return false;
+
+      const std::size_t begin = pos_;
+      while ( pos_ < text_.size() && !isSpace( text_[pos_] ) ) ++pos_;
+      entry = text_.substr( begin, pos_-begin );
+      return true;
+    }
+
+    // The characters that operator>> treats as separators in the "C" locale
+    static bool isSpace( char c ) {
+      return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+  private:
+
+    std::string_view text_;
+    std::size_t      pos_;
+
+  };
+
+  class MappedLineReader {
+
+  public:
+
+    explicit MappedLineReader( const std::string& filename )
+      : file_( filename )
+      , reader_( file_.contents() )
+    {}
+
+    // Sets entry to the next entry and returns true, or returns false
+    // at the end of the file
+    bool next( std::string_view& entry ) { return reader_.next( entry ); }
+
+    const MappedFile& file() const { return file_; }
+
+  private:
+
+    MappedFile  file_;
+    EntryReader reader_;
+
+  };
+
+} // end of namespace util
+
+#endif /* util_MappedFile_hh */
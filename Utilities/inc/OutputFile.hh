@@ -0,0 +1,27 @@
+#ifndef util_OutputFile_hh
+#define util_OutputFile_hh
+//
+// Writing of generated files.
+//
+// writeAtomically() writes the contents to a temporary file next to the
+// target with a single write() call and renames it over the target, so
+// a reader (or an interrupted run) never sees a partially written file.
+//
+// writeIfChanged() does the same, but only if the target does not
+// already hold exactly those bytes, so that unchanged files keep their
+// timestamps and do not trigger rebuilds of whatever includes them.
+// It returns true if the file was (re)written.
+//
+
+// C++ includes
+#include <string>
+#include <string_view>
+
+namespace util {
+
+  void writeAtomically( const std::string& filename, std::string_view contents );
+  bool writeIfChanged ( const std::string& filename, std::string_view contents );
+
+} // end of namespace util
+
+#endif /* util_OutputFile_hh */
@@ -0,0 +1,51 @@
+#ifndef util_OverlapCheck_hh
+#define util_OverlapCheck_hh
+//
+// Overlaps between the extruded volumes of the hall.
+//
+// Every volume is an extrusion of its polygon (the x/y vertices of its
+// SimpleConfig file, i.e. the horizontal footprint) over its height
+// range.  Candidate pairs are the volumes whose bounding boxes overlap
+// in a BoundingVolumeHierarchy built over footprint and height, which
+// implies that their height ranges overlap; for those the exact area
+// of the intersection of the two polygons is computed.  A pair is an
+// overlap if that area exceeds minArea, so volumes that only share
+// faces or edges are not reported.
+//
+// The intersection area of two simple polygons, convex or not, is
+// obtained from their fans of signed triangles about a common point:
+// the indicator function of a polygon is the signed sum of those of
+// its fan triangles, so the area of the intersection is the signed sum
+// of the areas of the pairwise triangle intersections, each of which
+// is a convex clip.  This is O(n*m) for polygons of n and m vertices,
+// with triangle pairs whose bounding boxes are disjoint skipped.
+//
+
+// Utilities includes
+#include "Utilities/inc/SimpleConfigVolume.hh"
+
+// C++ includes
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace util {
+
+  struct VolumeOverlap {
+    std::size_t first;       // indices into the checked volumes, first < second
+    std::size_t second;
+    double      area;        // of the intersection of the footprints (mm^2)
+    double      height;      // of the intersection of the height ranges (mm)
+    double      volume;      // area*height (mm^3)
+  };
+
+  // Area of the intersection of two simple polygons (mm^2)
+  double intersectionArea( std::span<const double> x1, std::span<const double> y1,
+                           std::span<const double> x2, std::span<const double> y2 );
+
+  // All overlapping pairs, ordered by first and then second index
+  std::vector<VolumeOverlap> findOverlaps( std::span<const SimpleConfigVolume> volumes, double minArea = 1. );
+
+} // end of namespace util
+
+#endif /* util_OverlapCheck_hh */
@@ -0,0 +1,45 @@
+#ifndef util_PolygonBoolean_hh
+#define util_PolygonBoolean_hh
+//
+// Boolean difference of two sets of polygons: the region covered by at
+// least one polygon of a first set (by the non-zero winding rule, so
+// either orientation is fine) and by none of a second set, returned as
+// non-overlapping simple polygons.
+//
+// The plane is cut into vertical strips at every vertex and at every
+// crossing of two edges, so that within a strip no two edges cross and
+// the region is a stack of trapezoids, found by counting the winding
+// number of both sets from the bottom of the strip up.  Trapezoids are
+// then grown into pieces across strip boundaries, accepting a
+// neighbour only if it touches the piece along exactly one segment:
+// this keeps every piece a topological disk (no holes, no vertices
+// where it touches itself), so that its boundary is one simple ring.
+// The pieces are few but not guaranteed minimal.
+//
+// Robustness comes from working on a grid: input vertices, the x of
+// the strip boundaries and the y where edges meet them are rounded to
+// multiples of the tolerance, so that edges and vertices shared by
+// several polygons up to rounding are treated as identical.  Vertices
+// closer than the tolerance to the line through their neighbours are
+// removed from the output.
+//
+
+// C++ includes
+#include <span>
+#include <vector>
+
+namespace util {
+
+  struct Polygon {
+    std::vector<double> x;
+    std::vector<double> y;
+  };
+
+  // The pieces are counter-clockwise
+  std::vector<Polygon> polygonDifference( std::span<const Polygon> covered,
+                                          std::span<const Polygon> removed,
+                                          double tolerance = 1.e-6 );
+
+} // end of namespace util
+
+#endif /* util_PolygonBoolean_hh */
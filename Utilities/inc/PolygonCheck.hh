@@ -0,0 +1,69 @@
+#ifndef util_PolygonCheck_hh
+#define util_PolygonCheck_hh
+//
+// Validity check of the polygons handed to TGeoXtru and written out as
+// xPositions/yPositions, which Geant4 extrudes and can only navigate
+// correctly if they are simple.
+//
+// checkPolygon() looks for
+//
+//   - fewer than three vertices, or a (numerically) zero signed area
+//   - zero-length edges, i.e. consecutive vertices that coincide,
+//     including a last vertex repeating the first one
+//   - the same vertex appearing again later in the polygon
+//   - the same edge appearing twice (in either direction)
+//   - edges that cross or touch, other than two consecutive edges
+//     meeting at their common vertex; consecutive edges that fold
+//     back onto each other count as touching
+//
+// Crossings are found with a Shamos-Hoey sweep line in O(n log n),
+// which stops at the first intersecting pair, so at most one crossing
+// is reported per polygon.  The other checks sort the vertices or
+// edges and are O(n log n) as well.
+//
+// The orientation (sign of the area) is reported but not judged: both
+// TGeoXtru and G4ExtrudedSolid accept either, and the .ccl files use
+// both.
+//
+
+// C++ includes
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace util {
+
+  struct PolygonProblem {
+
+    enum Kind {
+      TooFewVertices,
+      ZeroArea,
+      ZeroLengthEdge,      // edge i
+      DuplicateVertex,     // vertices i and j
+      DuplicateEdge,       // edges i and j
+      SelfIntersection     // edges i and j
+    };
+
+    Kind        kind;
+    std::size_t i = 0;
+    std::size_t j = 0;
+
+    // e.g. "edges 3 and 7 intersect", with the vertex/edge indices of
+    // the polygon (edge i goes from vertex i to vertex i+1)
+    std::string describe() const;
+  };
+
+  struct PolygonCheck {
+    double                      signedArea = 0.; // > 0 if counter-clockwise
+    std::vector<PolygonProblem> problems;
+
+    bool valid()     const { return problems.empty(); }
+    bool clockwise() const { return signedArea < 0.; }
+  };
+
+  PolygonCheck checkPolygon( std::span<const double> x, std::span<const double> y );
+
+} // end of namespace util
+
+#endif /* util_PolygonCheck_hh */
@@ -0,0 +1,158 @@
+#ifndef util_Profiler_hh
+#define util_Profiler_hh
+//
+// Per-stage instrumentation of ProduceSimpleConfig.
+//
+// The stages of the processing are marked with scopes,
+//
+//   UTIL_PROFILE_SCOPE(Parse);
+//
+// which, once Profiler::enable() has been called, collect the wall
+// time, the number of calls, the bytes read and written (reported by
+// MappedFile and OutputFile) and the number of operator new calls of
+// the enclosing block.  The time and allocations of nested scopes are
+// only counted in the innermost one, so the stages add up to the total.
+//
+// The counters are kept per thread and per volume: UTIL_PROFILE_VOLUME(
+// name ) attributes everything the calling thread does until the end
+// of the enclosing block to that volume (the input file); anything
+// outside a volume is attributed to "(global)".  writeJson() merges the
+// threads and dumps the totals and the per-volume counters.
+//
+// The allocations are counted by the replacement of the global
+// operator new in Utilities/obj/ProfilerAllocations.o, which is not
+// part of libUtilitiesCore.a: only programs that link it (e.g.
+// ProduceSimpleConfig) replace the allocator, and report 0 otherwise.
+//
+// If profiling is not enabled a scope costs one load and a branch.
+// Compiling with -DUTIL_NO_PROFILING turns the macros into no-ops and
+// removes the allocation counting altogether.
+//
+
+// C++ includes
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace util {
+
+  class Profiler {
+
+  public:
+
+    enum Stage {
+      Load,            // reading input files
+      Parse,           // coordinate lines to Coordinates
+      Resolve,         // reference resolution and absolute positions
+      Boundaries,      // world-boundary insertion
+      DirtInference,   // dirt volumes inferred from outlines
+      Validate,        // polygon validity checks
+      Merge,           // merging of volumes that share edges
+      Convex,          // convex decomposition of polygons
+      Emit,            // writing SimpleConfig files
+      TGeo,            // construction of the TGeo volumes
+      nStages
+    };
+
+    struct Counters {
+      std::size_t calls        = 0;
+      std::size_t wallNs       = 0;
+      std::size_t bytesRead    = 0;
+      std::size_t bytesWritten = 0;
+      std::size_t allocations  = 0;
+    };
+
+    using StageCounters = std::array<Counters,nStages>;
+
+    static const char* stageName( Stage stage );
+
+    static void enable();
+    static bool enabled() { return enabled_.load( std::memory_order_relaxed ); }
+
+    static void bytesRead   ( std::size_t n ) { if ( enabled() ) addBytes( n, 0 ); }
+    static void bytesWritten( std::size_t n ) { if ( enabled() ) addBytes( 0, n ); }
+
+    // Writes the collected counters; call when no scope is active
+    static void writeJson( const std::string& filename );
+
+    // Called by the counting operator new (ProfilerAllocations.cc)
+    static void countAllocation() { ++allocations_; }
+
+    class Scope {
+
+    public:
+
+      explicit Scope( Stage stage ) : active_( enabled() ) { if ( active_ ) begin( stage ); }
+      ~Scope() { if ( active_ ) end(); }
+
+      Scope( const Scope& ) = delete;
+      Scope& operator=( const Scope& ) = delete;
+
+    private:
+
+      friend class Profiler;
+
+      bool          active_;
+      Counters*     counters_;
+      Scope*        parent_;
+      std::uint64_t startNs_;
+      std::size_t   startAllocations_;
+      std::uint64_t childNs_;
+      std::size_t   childAllocations_;
+
+      void begin( Stage stage );
+      void end();
+
+    };
+
+    class Volume {
+
+    public:
+
+      explicit Volume( const std::string& name ) : active_( enabled() ) { if ( active_ ) begin( name ); }
+      ~Volume() { if ( active_ ) end(); }
+
+      Volume( const Volume& ) = delete;
+      Volume& operator=( const Volume& ) = delete;
+
+    private:
+
+      bool           active_;
+      StageCounters* previous_;
+
+      void begin( const std::string& name );
+      void end();
+
+    };
+
+  private:
+
+    static std::atomic<bool> enabled_;
+
+    // Number of operator new calls made by the calling thread
+    static thread_local std::size_t allocations_;
+
+    // Adds to the innermost active scope of the calling thread
+    static void addBytes( std::size_t read, std::size_t written );
+
+  };
+
+} // end of namespace util
+
+#ifndef UTIL_NO_PROFILING
+#define UTIL_PROFILE_CAT_(a,b) a##b
+#define UTIL_PROFILE_CAT(a,b)  UTIL_PROFILE_CAT_(a,b)
+#define UTIL_PROFILE_SCOPE(stage)     ::util::Profiler::Scope  UTIL_PROFILE_CAT(profileScope_ ,__LINE__)( ::util::Profiler::stage )
+#define UTIL_PROFILE_VOLUME(name)     ::util::Profiler::Volume UTIL_PROFILE_CAT(profileVolume_,__LINE__)( name )
+#define UTIL_PROFILE_BYTES_READ(n)    ::util::Profiler::bytesRead( n )
+#define UTIL_PROFILE_BYTES_WRITTEN(n) ::util::Profiler::bytesWritten( n )
+#else
+#define UTIL_PROFILE_SCOPE(stage)     do {} while (0)
+#define UTIL_PROFILE_VOLUME(name)     do {} while (0)
+#define UTIL_PROFILE_BYTES_READ(n)    do {} while (0)
+#define UTIL_PROFILE_BYTES_WRITTEN(n) do {} while (0)
+#endif
+
+#endif /* util_Profiler_hh */
@@ -0,0 +1,51 @@
+#ifndef util_SimpleConfigVolume_hh
+#define util_SimpleConfigVolume_hh
+//
+// Everything the SimpleConfig file of one volume holds, as values:
+// the parameters printSimpleConfigFile writes, in the same units (mm)
+// and frame (the polygon coordinates are wrt the volume origin given
+// by the offsets).
+//
+
+// C++ includes
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace util {
+
+  struct SimpleConfigVolume {
+    std::string name;                  // e.g. "dsArea"
+    std::string prefix;                // e.g. "building.dsArea"
+    std::string material;
+
+    double yMin = 0.;                  // height range
+    double yMax = 0.;
+
+    double offsetFromMu2eOriginX   = 0.;
+    double offsetFromFloorSurfaceY = 0.;
+    double offsetFromMu2eOriginZ   = 0.;
+    double yHalfThickness          = 0.;
+
+    std::vector<double>      x;        // vertex positions
+    std::vector<double>      y;
+    std::vector<std::size_t> xReplace; // vertices whose x/y Offline
+    std::vector<std::size_t> yReplace; // replaces by the world boundary
+  };
+
+  // Sets xReplace/yReplace to the vertices on the world boundary, for
+  // volumes that do not come from one .ccl file: those with x = +-worldX
+  // or y = +-worldY (half-lengths of the world) in the polygon frame
+  inline void setWorldReplace( SimpleConfigVolume& volume, double worldX, double worldY ) {
+    volume.xReplace.clear();
+    volume.yReplace.clear();
+    for ( std::size_t j(0) ; j < volume.x.size() ; ++j ) {
+      if ( std::abs( volume.x[j] ) == worldX ) volume.xReplace.push_back( j );
+      if ( std::abs( volume.y[j] ) == worldY ) volume.yReplace.push_back( j );
+    }
+  }
+
+} // end of namespace util
+
+#endif /* util_SimpleConfigVolume_hh */
@@ -0,0 +1,46 @@
+#ifndef util_SimpleConfigWriter_hh
+#define util_SimpleConfigWriter_hh
+//
+// SimpleConfig files of volumes given as values.  Volumes that do not
+// come from one .ccl file (merged volumes, the dirt complement) are
+// written as they are; CoordinateCollection::printSimpleConfigFile
+// writes its volumes with the same functions, adding the label of each
+// vertex.
+//
+
+// Utilities includes
+#include "Utilities/inc/Config.hh"
+#include "Utilities/inc/SimpleConfigVolume.hh"
+
+// C++ includes
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace util {
+
+  class TextBuffer;
+
+  // Adds the file dir+name+".txt" of the volume to config: its include
+  // line and prefix to the dirt lists if the prefix has "dirt.", to the
+  // building lists otherwise, and the file to outputFiles
+  void addSimpleConfigFile( Config& config, const SimpleConfigVolume& volume, const std::string& dir );
+
+  // Writes what follows the position of vertex j in the x and y lists,
+  // up to the end of the line
+  using VertexSuffix = std::function<void( TextBuffer& fs, std::size_t j )>;
+
+  // Appends the contents of that file to fs; comment holds the lines
+  // ("// ...\n") the file starts with.  Each position is followed by
+  // suffix, or if it is empty by a ',' unless it is the last one
+  void formatSimpleConfigFile( TextBuffer& fs, const SimpleConfigVolume& volume, std::string_view comment,
+                               const VertexSuffix& suffix = {} );
+
+  // Writes that file (if changed) and adds it to config
+  void printSimpleConfigFile( const SimpleConfigVolume& volume, std::string_view comment,
+                              Config& config, const std::string& dir );
+
+} // end of namespace util
+
+#endif /* util_SimpleConfigWriter_hh */
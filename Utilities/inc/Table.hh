@@ -98,18 +98,19 @@ namespace util {
 
     Table<N> tmp_table;
 
-    // Load table
-    while ( !intable.eof() ) {
-      TableRow<N> tableRow;
-      intable >> tableRow.first;              // Get key first
+    // Load table; a row is kept once its key and all its values were
+    // read, so the last row is kept even without a final newline
+    TableRow<N> tableRow;
+    while ( intable >> tableRow.first ) {     // Get key first
       std::for_each( tableRow.second.begin(), // Now fill the values
                      tableRow.second.end(),
                      [&](double& d){
                        intable >> d;
                      } );
-      if ( !intable.eof() ) {
-        tmp_table.rawTable_.emplace_back( tableRow.first, Value<N-1>( tableRow.second ) );
+      if ( !intable ) {
+        throw Exception("Incomplete row "+tableRow.first+" in tabulated spectrum table file "+tableFile);
       }
+      tmp_table.rawTable_.emplace_back( tableRow.first, Value<N-1>( tableRow.second ) );
 
     }
 
@@ -0,0 +1,55 @@
+#ifndef util_TextBuffer_hh
+#define util_TextBuffer_hh
+//
+// Growable character buffer for assembling an output file in memory.
+//
+// Numbers are formatted with std::to_chars: doubles in the shortest
+// form that reads back to exactly the same value (so, unlike the
+// 6-significant-digit default of an ostream, nothing is rounded away),
+// integers in plain decimal.  Neither depends on the locale.
+//
+// clear() keeps the allocated capacity, so a buffer reused from one
+// file to the next stops allocating once it has grown to the size of
+// the largest file.
+//
+
+// C++ includes
+#include <charconv>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace util {
+
+  class TextBuffer {
+
+  public:
+
+    TextBuffer& operator<<( std::string_view text ) { buffer_.append( text ); return *this; }
+    TextBuffer& operator<<( char c )                { buffer_.push_back( c ); return *this; }
+
+    TextBuffer& operator<<( double value )          { return appendNumber( value ); }
+    TextBuffer& operator<<( std::size_t value )     { return appendNumber( value ); }
+    TextBuffer& operator<<( int value )             { return appendNumber( value ); }
+
+    void             clear()       { buffer_.clear(); }
+    std::string_view view()  const { return buffer_; }
+    std::size_t      size()  const { return buffer_.size(); }
+
+  private:
+
+    std::string buffer_;
+
+    template <typename T>
+    TextBuffer& appendNumber( T value ) {
+      char digits[32];
+      const auto result = std::to_chars( digits, digits+sizeof(digits), value );
+      buffer_.append( digits, result.ptr );
+      return *this;
+    }
+
+  };
+
+} // end of namespace util
+
+#endif /* util_TextBuffer_hh */
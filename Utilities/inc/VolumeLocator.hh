@@ -0,0 +1,125 @@
+#ifndef util_VolumeLocator_hh
+#define util_VolumeLocator_hh
+//
+// Batch classification of points into the volumes of the hall: for
+// every point, the index of the volume that contains it.
+//
+// Points are given in Mu2e coordinates (mm), with y measured in the
+// frame of the Height lines of the .ccl files, i.e. wrt the floor
+// surface.  Each volume is placed the way Offline (and the TGeo
+// drawing of ProduceSimpleConfig) places it: its polygon is extruded
+// over [yMin,yMax), and polygon x/y become Mu2e z/x after adding
+// offsetFromMu2eOrigin.z/.x.
+//
+// Candidates come from a uniform grid over the extent of the volumes
+// (square in x-z, at most 16 layers in y): each cell lists, in
+// increasing order, the volumes whose boxes overlap it (found once with
+// a BoundingVolumeHierarchy), so a lookup is one cell and usually one
+// or two candidates.  Cells that no edge of a volume's polygon touches
+// are entirely inside or outside its footprint, which is decided when
+// the grid is built: outside candidates are dropped, and inside ones
+// only need the height test.  The other candidates are tested against
+// their height range and by counting crossings of a ray along +z with
+// their polygon edges.  The edges are stored per volume as flat
+// arrays, padded to a multiple of four with edges that are never
+// crossed, and tested a vector register at a time without branches
+// (GCC vector extensions: two edges with SSE2, four when compiled for
+// AVX).
+//
+// Edges and height ranges are half-open, and an edge shared by two
+// volumes (same end points) is evaluated identically for both, so a
+// point on such a face is in only one of them.  Where faces meet
+// without sharing vertices rounding decides; a point in several
+// volumes is given the lowest index.
+//
+
+// Utilities includes
+#include "Utilities/inc/BoundingVolumeHierarchy.hh"
+#include "Utilities/inc/SimpleConfigVolume.hh"
+
+// C++ includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace util {
+
+  class BinaryGeometry;
+
+  class VolumeLocator {
+
+  public:
+
+    typedef std::array<double,3> Point;   // Mu2e x, y (wrt floor surface), z
+
+    static constexpr std::uint32_t outside = std::numeric_limits<std::uint32_t>::max();
+
+    // Volume ids are the indices into volumes (or geometry)
+    explicit VolumeLocator( std::span<const SimpleConfigVolume> volumes );
+    explicit VolumeLocator( const BinaryGeometry& geometry );
+
+    std::size_t size() const { return slabs_.size(); }
+
+    // Id of the volume that contains the point, or outside
+    std::uint32_t locate( const Point& point ) const;
+
+    // ids[i] = locate( points[i] ), using nThreads threads (0 means one
+    // per hardware thread); ids must be as long as points
+    void classify( std::span<const Point> points, std::span<std::uint32_t> ids, unsigned nThreads = 1 ) const;
+
+    std::vector<std::uint32_t> classify( std::span<const Point> points, unsigned nThreads = 1 ) const;
+
+  private:
+
+    static constexpr std::size_t lanes = 4;
+
+    // Height range and edges [firstEdge,firstEdge+nEdges) of a volume
+    struct Slab {
+      double        yMin;
+      double        yMax;
+      std::uint32_t firstEdge;
+      std::uint32_t nEdges;
+    };
+
+    // Edge k runs from (z0,x0) to (.,x1); dzdx is its inverse slope
+    std::vector<double> z0_;
+    std::vector<double> x0_;
+    std::vector<double> x1_;
+    std::vector<double> dzdx_;
+
+    std::vector<Slab> slabs_;
+
+    // Cell (i,j,k) covers x in gridMin_[0]+[i,i+1)/gridScale_[0], and
+    // likewise for y and z; its volumes are
+    // cellVolumes_[cellStart_[c],cellStart_[c+1]) with c = (i*ny+j)*nz+k,
+    // flagged interior if the volume's footprint covers the cell
+    std::array<double,3>       gridMin_   = {};
+    std::array<double,3>       gridScale_ = {};
+    std::array<std::size_t,3>  gridSize_  = {};
+    std::vector<std::uint32_t> cellStart_;
+    std::vector<std::uint32_t> cellVolumes_;
+
+    static constexpr std::uint32_t interior = 1u << 31;
+
+    struct Box;
+
+    void add( std::span<const double> x, std::span<const double> y,
+              double yMin, double yMax, double offsetX, double offsetZ,
+              std::vector<Box>& boxes );
+
+    void buildGrid( const std::vector<Box>& boxes );
+
+    // Whether an edge of the polygon touches the x-z rectangle of cell
+    static bool crossesCell( const Box& box, const BoundingVolumeHierarchy::Box& cell );
+
+    // Whether (px,pz) is inside the polygon of slab
+    bool inFootprint( const Slab& slab, double px, double pz ) const;
+
+  };
+
+} // end of namespace util
+
+#endif /* util_VolumeLocator_hh */
@@ -0,0 +1,44 @@
+#ifndef util_VolumeMerge_hh
+#define util_VolumeMerge_hh
+//
+// Merging of volumes that are drawn in several pieces, e.g.
+// dsArea.downstreamCeiling.vslab1..6.
+//
+// Volumes of the same kind (dirt or building), height range, material
+// and offsets are connected if their polygons share part of a boundary
+// edge: two edges that are collinear within the tolerance and overlap
+// over more than it.  Each connected group is replaced by the union of
+// its polygons (polygonDifference with nothing removed) if that takes
+// fewer polygons than the group has volumes; a group whose union has a
+// hole, for instance, stays as it is if the union needs as many pieces.
+//
+// A merged volume is named after the dotted prefix its members have in
+// common, e.g. building.floor.merged, or after its first member if
+// they only have "building" or "dirt" in common (with the number of
+// the piece appended if there are several, and a further number if
+// the prefix is taken).  Vertices on the world boundary (x =
+// +-worldX, y = +-worldY) are listed in xReplace/yReplace.
+//
+
+// Utilities includes
+#include "Utilities/inc/SimpleConfigVolume.hh"
+
+// C++ includes
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace util {
+
+  struct VolumeMerge {
+    std::vector<std::size_t>        members;  // indices of the merged volumes, increasing
+    std::vector<SimpleConfigVolume> volumes;  // that replace them
+  };
+
+  std::vector<VolumeMerge> mergeVolumes( std::span<const SimpleConfigVolume> volumes,
+                                         double worldX, double worldY,
+                                         double tolerance = 1.e-6 );
+
+} // end of namespace util
+
+#endif /* util_VolumeMerge_hh */
@@ -0,0 +1,70 @@
+#ifndef util_parallelFor_hh
+#define util_parallelFor_hh
+//
+// Run a callable over the indices [0,n) on a small pool of threads.
+//
+// Arguments:
+//   1 - the number of work items
+//   2 - the number of threads to use (0 means one per hardware thread)
+//   3 - the callable, invoked as f(index)
+//
+// Work items are handed out one at a time in increasing index order,
+// so the callable should write its result into a slot owned by that
+// index rather than into shared state.  If any invocation throws, the
+// remaining items are abandoned and the exception belonging to the
+// lowest index is rethrown in the calling thread, so that the error
+// reported does not depend on thread scheduling.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace util {
+
+  inline unsigned resolveThreadCount( unsigned nThreads, std::size_t nItems ) {
+    if ( nThreads == 0 ) nThreads = std::max( 1u, std::thread::hardware_concurrency() );
+    return static_cast<unsigned>( std::max<std::size_t>( 1, std::min<std::size_t>( nThreads, nItems ) ) );
+  }
+
+  template <typename F>
+  void parallelFor( std::size_t n, unsigned nThreads, F&& f ) {
+
+    nThreads = resolveThreadCount( nThreads, n );
+
+    if ( nThreads == 1 ) {
+      for ( std::size_t i(0) ; i < n ; ++i ) f(i);
+      return;
+    }
+
+    std::vector<std::exception_ptr> errors( n );
+    std::atomic<std::size_t> next(0);
+    std::atomic<bool>        failed(false);
+
+    auto worker = [&](){
+      for ( std::size_t i = next++ ; i < n && !failed ; i = next++ ) {
+        try {
+          f(i);
+        }
+        catch (...) {
+          errors[i] = std::current_exception();
+          failed    = true;
+        }
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for ( unsigned t(0) ; t < nThreads ; ++t ) threads.emplace_back( worker );
+    for ( auto& thread : threads ) thread.join();
+
+    for ( const auto& error : errors ) {
+      if ( error ) std::rethrow_exception( error );
+    }
+  }
+
+} // namespace util
+
+#endif /* util_parallelFor_hh */
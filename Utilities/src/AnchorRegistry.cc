@@ -0,0 +1,77 @@
+// Reference points shared by all .ccl files of a run.
+
+#include "Utilities/inc/AnchorRegistry.hh"
+#include "Utilities/inc/MappedFile.hh"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace util {
+
+  //=========================================================================
+  AnchorRegistry::AnchorRegistry( const std::string& filename )
+    : filename_( filename )
+  {
+    MappedLineReader reader( filename_ );
+
+    // Same inheritance and transform as in CoordinateCollection, one
+    // point at a time: abs = ref + R(phi)*rel
+    std::string refLabel("*");
+    double      rotation(0.);
+
+    std::string_view entry;
+    while ( reader.next( entry ) ) {
+      const Coordinate coord( entry );
+
+      if ( coord.worldBoundary() != worldDir::none )
+        throw std::runtime_error( "Anchor << "+coord.label()+" >> cannot have a wall reference, in file: "+filename_ );
+
+      const bool first = positions_.empty();
+      if ( !first && !coord.refLabel().empty() ) refLabel = coord.refLabel();
+      if ( !first && coord.rot() >= -360       ) rotation = coord.rot();
+
+      const Coordinate::Rep<double>& rel = coord.getCoordRel();
+      Coordinate::Rep<double> position = rel;
+
+      // Exact if the reference is, and the rotation a quarter turn
+      std::optional<Coordinate::Rep<FixedLength>> fixed = toFixed( coord.getCoordStd() );
+
+      if ( !first ) {
+        const auto ref = positions_.find( refLabel );
+        if ( ref == positions_.end() )
+          throw std::runtime_error( "Reference anchor << "+refLabel+" >> does not exist yet, in file: "+filename_ );
+
+        const double phi    = rotation*M_PI/180;
+        const double cosPhi = std::cos( phi );
+        const double sinPhi = std::sin( phi );
+        position = { ref->second.at(0) + cosPhi*rel.at(0) - sinPhi*rel.at(1),
+                     ref->second.at(1) + sinPhi*rel.at(0) + cosPhi*rel.at(1) };
+
+        const auto fixedRef = fixedPositions_.find( refLabel );
+        const auto turns    = quarterTurns( rotation );
+        if ( fixed && turns && fixedRef != fixedPositions_.end() ) {
+          const Coordinate::Rep<FixedLength> rotated = rotateFixed( *fixed, *turns );
+          fixed = Coordinate::Rep<FixedLength>{ fixedRef->second.at(0)+rotated.at(0), fixedRef->second.at(1)+rotated.at(1) };
+        }
+        else fixed.reset();
+      }
+      if ( fixed ) fixedPositions_.emplace( coord.label(), *fixed );
+
+      if ( !positions_.emplace( coord.label(), position ).second )
+        throw std::runtime_error( "Anchor << "+coord.label()+" >> already used, in file: "+filename_ );
+    }
+  }
+
+  //=========================================================================
+  const Coordinate::Rep<double>* AnchorRegistry::find( std::string_view label ) const {
+    const auto match = positions_.find( std::string( label ) );
+    return match != positions_.end() ? &match->second : nullptr;
+  }
+
+  //=========================================================================
+  const Coordinate::Rep<FixedLength>* AnchorRegistry::findFixed( std::string_view label ) const {
+    const auto match = fixedPositions_.find( std::string( label ) );
+    return match != fixedPositions_.end() ? &match->second : nullptr;
+  }
+
+} // end of namespace util
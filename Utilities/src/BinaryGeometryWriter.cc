@@ -0,0 +1,111 @@
+// Writing of the binary geometry file.
+
+#include "Utilities/inc/BinaryGeometryWriter.hh"
+#include "Utilities/inc/BinaryGeometry.hh"
+#include "Utilities/inc/OutputFile.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+  std::uint64_t align8( std::uint64_t offset ) { return ( offset+7 ) & ~std::uint64_t(7); }
+
+  std::uint32_t count( std::size_t n, const std::string& what ) {
+    if ( n > std::numeric_limits<std::uint32_t>::max() )
+      throw std::runtime_error( "Too many entries for binary geometry: "+what );
+    return static_cast<std::uint32_t>( n );
+  }
+
+  template <typename T>
+  void put( std::string& buffer, std::uint64_t offset, const T& value ) {
+    std::memcpy( buffer.data()+offset, &value, sizeof(T) );
+  }
+
+}
+
+namespace util {
+
+  //=========================================================================
+  bool writeBinaryGeometry( const std::string& filename, std::vector<SimpleConfigVolume> volumes ) {
+
+    using namespace binaryGeometry;
+
+    std::sort( volumes.begin(), volumes.end(),
+               []( const SimpleConfigVolume& a, const SimpleConfigVolume& b ){ return a.prefix < b.prefix; } );
+
+    // Lay out the file: records, then the arrays of each volume, then
+    // the strings
+    std::vector<VolumeRecord> records( volumes.size() );
+
+    std::uint64_t offset = sizeof(FileHeader)+volumes.size()*sizeof(VolumeRecord);
+    for ( std::size_t i(0) ; i < volumes.size() ; ++i ) {
+      const SimpleConfigVolume& v = volumes[i];
+      VolumeRecord& r = records[i];
+      std::memset( &r, 0, sizeof(r) );
+
+      if ( v.y.size() != v.x.size() ) throw std::runtime_error( "Vertex arrays of different lengths in volume "+v.prefix );
+      r.nVertices = count( v.x.size()       , v.prefix );
+      r.nXReplace = count( v.xReplace.size(), v.prefix );
+      r.nYReplace = count( v.yReplace.size(), v.prefix );
+
+      r.yMin                    = v.yMin;
+      r.yMax                    = v.yMax;
+      r.offsetFromMu2eOriginX   = v.offsetFromMu2eOriginX;
+      r.offsetFromFloorSurfaceY = v.offsetFromFloorSurfaceY;
+      r.offsetFromMu2eOriginZ   = v.offsetFromMu2eOriginZ;
+      r.yHalfThickness          = v.yHalfThickness;
+
+      r.xOffset        = offset; offset += r.nVertices*sizeof(double);
+      r.yOffset        = offset; offset += r.nVertices*sizeof(double);
+      r.xReplaceOffset = offset; offset += r.nXReplace*sizeof(std::uint32_t);
+      r.yReplaceOffset = offset; offset += r.nYReplace*sizeof(std::uint32_t);
+      offset = align8( offset );
+    }
+
+    for ( std::size_t i(0) ; i < volumes.size() ; ++i ) {
+      const SimpleConfigVolume& v = volumes[i];
+      VolumeRecord& r = records[i];
+      r.nameOffset     = offset; r.nameLength     = count( v.name.size()    , v.prefix ); offset += r.nameLength+1;
+      r.prefixOffset   = offset; r.prefixLength   = count( v.prefix.size()  , v.prefix ); offset += r.prefixLength+1;
+      r.materialOffset = offset; r.materialLength = count( v.material.size(), v.prefix ); offset += r.materialLength+1;
+    }
+
+    // Fill the buffer; it starts zeroed, which provides the padding and
+    // the string terminators
+    std::string buffer( offset, '\0' );
+
+    FileHeader header;
+    std::memset( &header, 0, sizeof(header) );
+    std::memcpy( header.magic, magic, sizeof(header.magic) );
+    header.version       = version;
+    header.endianTag     = endianTag;
+    header.nVolumes      = count( volumes.size(), "volumes" );
+    header.recordSize    = sizeof(VolumeRecord);
+    header.fileSize      = offset;
+    header.recordsOffset = sizeof(FileHeader);
+    put( buffer, 0, header );
+
+    for ( std::size_t i(0) ; i < volumes.size() ; ++i ) {
+      const SimpleConfigVolume& v = volumes[i];
+      const VolumeRecord& r = records[i];
+      put( buffer, header.recordsOffset+i*sizeof(VolumeRecord), r );
+
+      std::memcpy( buffer.data()+r.xOffset, v.x.data(), r.nVertices*sizeof(double) );
+      std::memcpy( buffer.data()+r.yOffset, v.y.data(), r.nVertices*sizeof(double) );
+      for ( std::uint32_t j(0) ; j < r.nXReplace ; ++j )
+        put( buffer, r.xReplaceOffset+j*sizeof(std::uint32_t), count( v.xReplace[j], v.prefix ) );
+      for ( std::uint32_t j(0) ; j < r.nYReplace ; ++j )
+        put( buffer, r.yReplaceOffset+j*sizeof(std::uint32_t), count( v.yReplace[j], v.prefix ) );
+
+      std::memcpy( buffer.data()+r.nameOffset    , v.name.data()    , r.nameLength     );
+      std::memcpy( buffer.data()+r.prefixOffset  , v.prefix.data()  , r.prefixLength   );
+      std::memcpy( buffer.data()+r.materialOffset, v.material.data(), r.materialLength );
+    }
+
+    return writeIfChanged( filename, buffer );
+  }
+
+} // end of namespace util
@@ -0,0 +1,70 @@
+// Bounding-volume hierarchy over axis-aligned boxes.
+
+#include "Utilities/inc/BoundingVolumeHierarchy.hh"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace util {
+
+  //=========================================================================
+  BoundingVolumeHierarchy::BoundingVolumeHierarchy( std::vector<Box> boxes )
+    : boxes_( std::move( boxes ) )
+    , items_( boxes_.size() )
+  {
+    if ( boxes_.size() > std::numeric_limits<std::uint32_t>::max()/2 )
+      throw std::runtime_error( "Too many boxes for a bounding-volume hierarchy" );
+
+    std::iota( items_.begin(), items_.end(), 0 );
+    if ( boxes_.empty() ) return;
+
+    nodes_.reserve( 2*( boxes_.size()/leafSize+1 ) );
+    nodes_.emplace_back();
+    build( 0, 0, boxes_.size() );
+  }
+
+  //=========================================================================
+  void BoundingVolumeHierarchy::build( std::uint32_t node, std::uint32_t begin, std::uint32_t end ) {
+
+    Box bounds = boxes_[ items_[begin] ];
+    for ( std::uint32_t k = begin+1 ; k < end ; ++k ) {
+      const Box& b = boxes_[ items_[k] ];
+      for ( std::size_t a(0) ; a < 3 ; ++a ) {
+        bounds.min[a] = std::min( bounds.min[a], b.min[a] );
+        bounds.max[a] = std::max( bounds.max[a], b.max[a] );
+      }
+    }
+    nodes_[node].box = bounds;
+
+    if ( end-begin <= leafSize ) {
+      nodes_[node].first = begin;
+      nodes_[node].count = end-begin;
+      return;
+    }
+
+    // Split at the median centre along the longest axis
+    std::size_t axis(0);
+    for ( std::size_t a(1) ; a < 3 ; ++a ) {
+      if ( bounds.max[a]-bounds.min[a] > bounds.max[axis]-bounds.min[axis] ) axis = a;
+    }
+
+    const std::uint32_t middle = begin+(end-begin)/2;
+    std::nth_element( items_.begin()+begin, items_.begin()+middle, items_.begin()+end,
+                      [&]( std::uint32_t a, std::uint32_t b ){
+                        return boxes_[a].min[axis]+boxes_[a].max[axis] < boxes_[b].min[axis]+boxes_[b].max[axis];
+                      } );
+
+    // The children are adjacent, the left one at index first
+    const std::uint32_t left = nodes_.size();
+    nodes_.emplace_back();
+    nodes_.emplace_back();
+    nodes_[node].first = left;
+    nodes_[node].count = 0;
+
+    build( left  , begin , middle );
+    build( left+1, middle, end    );
+  }
+
+} // end of namespace util
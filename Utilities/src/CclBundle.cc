@@ -0,0 +1,99 @@
+// Many .ccl files in one file.
+
+#include "Utilities/inc/CclBundle.hh"
+#include "Utilities/inc/OutputFile.hh"
+
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+
+namespace {
+
+  bool isBlank( char c ) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f'; }
+
+  // A plain file name that the marker line and splitCclBundle keep intact
+  bool validName( std::string_view name ) {
+    return !name.empty() && name != "." && name != ".." &&
+      name.find('/') == std::string_view::npos && std::none_of( name.begin(), name.end(), isBlank );
+  }
+
+}
+
+namespace util {
+
+  //=========================================================================
+  CclBundle::CclBundle( const std::string& filename )
+    : file_( filename )
+  {
+    const std::string_view text = file_.contents();
+    EntryReader reader( text );
+
+    std::set<std::string_view> names;
+    std::string_view entry;
+    while ( reader.next( entry ) ) {
+      if ( !entry.starts_with( marker ) ) {
+        if ( volumes_.empty() ) throw std::runtime_error( "Bundle "+filename+" does not start with a "+std::string(marker)+" entry" );
+        continue;
+      }
+
+      const std::size_t begin = entry.data()-text.data();
+      if ( !volumes_.empty() ) {
+        Volume& previous = volumes_.back();
+        previous.text = text.substr( previous.text.data()-text.data(), begin-( previous.text.data()-text.data() ) );
+      }
+
+      // The name is the rest of the marker line, so that a name with
+      // whitespace is rejected rather than cut at the first blank
+      std::size_t lineEnd = text.find( '\n', begin );
+      if ( lineEnd == std::string_view::npos ) lineEnd = text.size();
+      std::string_view name = text.substr( begin+marker.size(), lineEnd-begin-marker.size() );
+      while ( !name.empty() && isBlank( name.back() ) ) name.remove_suffix( 1 );
+
+      if ( !validName( name ) )
+        throw std::runtime_error( "Invalid volume name << "+std::string(name)+" >> in bundle "+filename );
+      if ( !names.insert( name ).second )
+        throw std::runtime_error( "Volume name << "+std::string(name)+" >> repeated in bundle "+filename );
+
+      // The text starts on the line after the marker
+      const std::size_t textBegin = lineEnd == text.size() ? lineEnd : lineEnd+1;
+      volumes_.push_back( { name, text.substr( textBegin, 0 ) } );
+    }
+
+    if ( !volumes_.empty() ) {
+      Volume& last = volumes_.back();
+      last.text = text.substr( last.text.data()-text.data() );
+    }
+  }
+
+  //=========================================================================
+  void writeCclBundle( std::span<const std::string> cclFiles, const std::string& bundle ) {
+
+    std::set<std::string> names;
+    std::string contents;
+    for ( const auto& cclFile : cclFiles ) {
+      const std::size_t slash = cclFile.rfind( '/' );
+      const std::string name  = slash == std::string::npos ? cclFile : cclFile.substr( slash+1 );
+      if ( !validName( name ) )
+        throw std::runtime_error( "File name << "+name+" >> is empty or has whitespace and cannot be bundled" );
+      if ( !names.insert( name ).second )
+        throw std::runtime_error( "Two files named << "+name+" >> cannot be bundled together" );
+
+      const MappedFile file( cclFile );
+      contents += CclBundle::marker;
+      contents += name;
+      contents += '\n';
+      contents += file.contents();
+      if ( !contents.ends_with( '\n' ) ) contents += '\n';
+    }
+    writeIfChanged( bundle, contents );
+  }
+
+  //=========================================================================
+  void splitCclBundle( const std::string& bundle, const std::string& directory ) {
+    const CclBundle cclBundle( bundle );
+    for ( const auto& volume : cclBundle.volumes() ) {
+      writeIfChanged( directory+"/"+std::string( volume.name ), volume.text );
+    }
+  }
+
+} // end of namespace util
@@ -0,0 +1,191 @@
+// Convex decomposition of simple polygons (ear clipping and Hertel-Mehlhorn).
+
+#include "Utilities/inc/ConvexDecomposition.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+
+namespace {
+
+  struct Point { double x, y; };
+
+  double cross( const Point& a, const Point& b, const Point& c ) {
+    return (b.x-a.x)*(c.y-b.y) - (b.y-a.y)*(c.x-b.x);
+  }
+
+  // Whether b is (almost) on the line from a to c, relative to the
+  // length of that line so that it does not depend on the units
+  bool collinear( const Point& a, const Point& b, const Point& c ) {
+    const double dx = c.x-a.x, dy = c.y-a.y;
+    return std::abs( cross( a, b, c ) ) <= 1.e-12*( dx*dx+dy*dy );
+  }
+
+  double signedArea( const std::vector<Point>& points, const std::vector<std::size_t>& ring ) {
+    double area(0);
+    for ( std::size_t i(0) ; i < ring.size() ; ++i ) {
+      const Point& a = points[ring[i]];
+      const Point& b = points[ring[(i+1)%ring.size()]];
+      area += a.x*b.y - b.x*a.y;
+    }
+    return area/2;
+  }
+
+  // Vertices collinear with their neighbours (and repeated ones) removed
+  std::vector<std::size_t> dropCollinear( const std::vector<Point>& points, std::vector<std::size_t> ring ) {
+    bool changed = true;
+    while ( changed && ring.size() > 3 ) {
+      changed = false;
+      for ( std::size_t i(0) ; i < ring.size() && ring.size() > 3 ; ) {
+        const std::size_t n = ring.size();
+        if ( collinear( points[ring[(i+n-1)%n]], points[ring[i]], points[ring[(i+1)%n]] ) ) {
+          ring.erase( ring.begin()+i );
+          changed = true;
+        }
+        else ++i;
+      }
+    }
+    return ring;
+  }
+
+  bool inTriangle( const Point& a, const Point& b, const Point& c, const Point& p ) {
+    return cross( a, b, p ) >= 0 && cross( b, c, p ) >= 0 && cross( c, a, p ) >= 0;
+  }
+
+  // Ear clipping of a counter-clockwise ring; empty if no ear is found
+  std::vector<std::vector<std::size_t>> triangulate( const std::vector<Point>& points, std::vector<std::size_t> ring ) {
+    std::vector<std::vector<std::size_t>> triangles;
+    std::size_t k(0);
+    while ( ring.size() > 3 ) {
+      const std::size_t n = ring.size();
+      bool clipped = false;
+      for ( std::size_t tries(0) ; tries < n && !clipped ; ++tries, k = (k+1)%n ) {
+        const std::size_t a = ring[(k+n-1)%n], b = ring[k], c = ring[(k+1)%n];
+        if ( cross( points[a], points[b], points[c] ) <= 0 ) continue;
+        bool ear = true;
+        for ( std::size_t p : ring ) {
+          if ( p == a || p == b || p == c ) continue;
+          if ( inTriangle( points[a], points[b], points[c], points[p] ) ) { ear = false; break; }
+        }
+        if ( !ear ) continue;
+        triangles.push_back( { a, b, c } );
+        ring.erase( ring.begin()+k );
+        clipped = true;
+      }
+      if ( !clipped ) return {};
+      k %= ring.size();
+    }
+    triangles.push_back( ring );
+    return triangles;
+  }
+
+  // Rotates the piece so that it starts with vertex first
+  void rotateTo( std::vector<std::size_t>& piece, std::size_t first ) {
+    std::rotate( piece.begin(), std::find( piece.begin(), piece.end(), first ), piece.end() );
+  }
+
+  // Hertel-Mehlhorn: removes the diagonals of the triangulation, longest
+  // first, whose removal leaves both end points convex
+  std::vector<std::vector<std::size_t>> mergeTriangles( const std::vector<Point>& points,
+                                                        std::vector<std::vector<std::size_t>> pieces ) {
+
+    std::map<std::pair<std::size_t,std::size_t>,std::size_t> owner;   // directed edge -> piece
+    for ( std::size_t p(0) ; p < pieces.size() ; ++p ) {
+      for ( std::size_t i(0) ; i < 3 ; ++i ) owner[ { pieces[p][i], pieces[p][(i+1)%3] } ] = p;
+    }
+
+    std::vector<std::pair<std::size_t,std::size_t>> diagonals;
+    for ( const auto& edge : owner ) {
+      if ( edge.first.first < edge.first.second && owner.count( { edge.first.second, edge.first.first } ) ) diagonals.push_back( edge.first );
+    }
+    auto length = [&]( const std::pair<std::size_t,std::size_t>& d ){
+      return std::hypot( points[d.first].x-points[d.second].x, points[d.first].y-points[d.second].y );
+    };
+    std::stable_sort( diagonals.begin(), diagonals.end(),
+                      [&]( const auto& a, const auto& b ){ return length( a ) > length( b ); } );
+
+    std::vector<bool> alive( pieces.size(), true );
+    for ( const auto& [u, v] : diagonals ) {
+      const std::size_t p = owner.at( { u, v } ), q = owner.at( { v, u } );
+      std::vector<std::size_t> a = pieces[p], b = pieces[q];
+      rotateTo( a, v );   // v ... u, closed by the diagonal u -> v
+      rotateTo( b, u );   // u ... v, closed by the diagonal v -> u
+      if ( cross( points[a[a.size()-2]], points[u], points[b[1]] ) < 0 ) continue;
+      if ( cross( points[b[b.size()-2]], points[v], points[a[1]] ) < 0 ) continue;
+
+      a.insert( a.end(), b.begin()+1, b.end()-1 );
+      owner.erase( { u, v } );
+      owner.erase( { v, u } );
+      for ( std::size_t i(0) ; i < a.size() ; ++i ) {
+        const std::pair<std::size_t,std::size_t> edge( a[i], a[(i+1)%a.size()] );
+        if ( owner.count( edge ) ) owner[edge] = p;
+      }
+      pieces[p] = std::move( a );
+      alive[q]  = false;
+    }
+
+    std::vector<std::vector<std::size_t>> result;
+    for ( std::size_t p(0) ; p < pieces.size() ; ++p ) {
+      if ( alive[p] ) result.push_back( dropCollinear( points, std::move( pieces[p] ) ) );
+    }
+    return result;
+  }
+
+  double cost( std::size_t vertices, bool convex ) {
+    return convex ? vertices+2. : 3.*vertices-4.;
+  }
+
+}
+
+namespace util {
+
+  //=========================================================================
+  ConvexDecomposition decomposeConvex( std::span<const double> x, std::span<const double> y ) {
+
+    ConvexDecomposition result;
+
+    const std::size_t n = std::min( x.size(), y.size() );
+    std::vector<Point> points;
+    std::vector<std::size_t> ring;
+    for ( std::size_t i(0) ; i < n ; ++i ) {
+      points.push_back( { x[i], y[i] } );
+      ring.push_back( i );
+    }
+    ring = dropCollinear( points, std::move( ring ) );
+    if ( ring.size() < 3 ) return result;
+    if ( signedArea( points, ring ) < 0 ) std::reverse( ring.begin(), ring.end() );
+
+    result.vertices = ring.size();
+    for ( std::size_t i(0) ; i < ring.size() ; ++i ) {
+      const std::size_t m = ring.size();
+      if ( cross( points[ring[(i+m-1)%m]], points[ring[i]], points[ring[(i+1)%m]] ) < 0 ) ++result.reflex;
+    }
+    result.cost = cost( result.vertices, result.reflex == 0 );
+
+    std::vector<std::vector<std::size_t>> pieces;
+    if ( result.reflex == 0 ) pieces.push_back( ring );
+    else {
+      pieces = triangulate( points, ring );
+      if ( pieces.empty() ) return result;
+      pieces = mergeTriangles( points, std::move( pieces ) );
+    }
+
+    double totalArea(0);
+    for ( const auto& piece : pieces ) {
+      Polygon polygon;
+      for ( std::size_t i : piece ) {
+        polygon.x.push_back( points[i].x );
+        polygon.y.push_back( points[i].y );
+      }
+      const double area = signedArea( points, piece );
+      totalArea       += area;
+      result.meanCost += area*cost( piece.size(), true );
+      result.sumCost  += cost( piece.size(), true );
+      result.pieces.push_back( std::move( polygon ) );
+    }
+    if ( totalArea > 0 ) result.meanCost /= totalArea;
+    return result;
+  }
+
+} // end of namespace util
@@ -1,7 +1,7 @@
 // Original author: Kyle Knoepfel
 
 #include "Utilities/inc/Coordinate.hh"
-#include "Utilities/inc/splitLine.hh"
+#include "Utilities/inc/CoordinateParser.hh"
 
 #include <cctype>
 #include <cmath>
@@ -20,7 +20,7 @@ namespace {
 namespace util {
 
   //=========================================================================
-  Coordinate::Coordinate( const std::string& inputString )
+  Coordinate::Coordinate( std::string_view inputString )
     : inputString_(inputString)
     , rotWrtRef_(-1000.)
     , draw_(true)
@@ -42,6 +42,8 @@ namespace util {
     , draw_(draw)
     , isOut_(isOut)
     , worldBoundary_( worldBoundary )
+    , coordStd_()
+    , coordRel_( point ) // an absolute point is its own relative position
     , coord_( point )
   {}
 
@@ -51,72 +53,20 @@ namespace util {
 
     // Assign label, references, and coordinate string assuming form:
     // "B)[N]<A|14>xStd:yStd
-    const std::size_t labelDelim     = inputString.find(")");
-    const std::size_t wallLeftDelim  = inputString.find("[");
-    const std::size_t wallRightDelim = inputString.find("]");
-    const std::size_t refLeftDelim   = inputString.find("<");
-    const std::size_t refRightDelim  = inputString.find(">");
-    const std::size_t rotDelim       = inputString.find("|");
-
-    // Get label
-    if ( labelDelim != std::string::npos ) label_ = inputString.substr( 0, labelDelim );
-    else throw std::runtime_error( "Label not specified for coordinate: "+inputString );
-
-    // Check if draw flag should be set
-    if ( label_.find("//") != std::string::npos ) {
-      draw_ = false;
-      label_ = label_.substr( label_.find_last_of("/")+1 );
-    }
-
-    // Check if coordinate represents point on the outside
-    if ( std::islower( label_[0] ) ) isOut_ = true;
-
-    // Make sure there's an ordered pair
-    if ( inputString.find(",") == std::string::npos )
-      throw std::runtime_error("Label << "+label_+" >> has no ordered pair!  You probably forgot the ',' character." );
-
-    // Get origin reference
-    const bool newOrigin = ( refLeftDelim != std::string::npos && refRightDelim != std::string::npos );
-    const bool oldOrigin = ( refLeftDelim == std::string::npos && refRightDelim == std::string::npos );
-    if ( !newOrigin && !oldOrigin ) throw std::runtime_error(" Missing \"<\" or \">\" for coordinate \""+inputString+"\"");
-
-    // Get wall reference
-    const bool yesWallRef  = ( wallLeftDelim != std::string::npos && wallRightDelim != std::string::npos );
-    const bool noWallRef   = ( wallLeftDelim == std::string::npos && wallRightDelim == std::string::npos );
-    if ( !yesWallRef && !noWallRef ) throw std::runtime_error(" Missing \"[\" or \"]\" for coordinate \""+inputString+"\"");
-    if (  yesWallRef && !newOrigin ) throw std::runtime_error(" Must specify reference point \"<something_here>\" when adding wall reference! (for "+inputString+")\n");
-
-    if ( yesWallRef ) {
-      worldBoundary_ = worldDir::stringToEnum( inputString.substr( wallLeftDelim+1, wallRightDelim-wallLeftDelim-1 ) );
-    }
-
-    // Check for rotation
-    const bool newRotation = ( rotDelim != std::string::npos ) && (refRightDelim-rotDelim-1 != 0);
-
-    // Reassign reference origin and rotation as necessary
-    if ( newRotation ) rotWrtRef_  = std::atof( inputString.substr(rotDelim+1,refRightDelim-rotDelim-1).c_str() );
-    if ( newOrigin   ){
-      const std::string bracketString = inputString.substr(refLeftDelim+1,refRightDelim-refLeftDelim-1);
-      if      ( !newRotation && refRightDelim-refLeftDelim-1 != 0 && bracketString != "|") refLabel_ = bracketString.substr(0,bracketString.find("|"));
-      else if (  newRotation && rotDelim     -refLeftDelim-1 != 0) refLabel_ = inputString.substr(refLeftDelim+1,rotDelim-refLeftDelim-1);
-    }
-
-    // Get coordinate string
-    coordStr_ =
-      refRightDelim != std::string::npos ?
-      inputString.substr( refRightDelim+1 ) :
-      inputString.substr( labelDelim+1 );
-
-    if ( coordStr_.empty() ) throw std::runtime_error( "No coordinate exists for label << "+label_+" >>!");
-
-    // Parse coordinates
-    std::vector<std::string> parts;
-    splitLine( coordStr_, ",", parts );
-
-    FtInchPair xStd = makeFtInchPair( parts.at(0) );
-    FtInchPair yStd = makeFtInchPair( parts.at(1) );
-
-    return {xStd,yStd};
+    ParsedCoordinate parsed;
+    parseCoordinate( inputString, parsed );
+
+    label_         = parsed.label;
+    draw_          = parsed.draw;
+    isOut_         = parsed.isOut;
+    worldBoundary_ = parsed.worldBoundary;
+
+    // Reference and rotation are left unset (to be inherited from the
+    // previous coordinate) if not specified
+    if ( parsed.hasRotation        ) rotWrtRef_ = parsed.rotation;
+    if ( !parsed.refLabel.empty()  ) refLabel_  = parsed.refLabel;
+
+    return parsed.coordStd;
   }
 
 
@@ -132,21 +82,16 @@ namespace util {
 
   //=========================================================================
   Coordinate::FtInchPair Coordinate::makeFtInchPair( const std::string& stringToParse ) {
-    std::vector<std::string> stringPairing;
-    splitLine( stringToParse, ":", stringPairing );
-
-    const int    ft = ( stringPairing.size() > 0 ) ? std::atoi( stringPairing.at(0).c_str() ) : 0;
-    const double in = ( stringPairing.size() > 1 ) ? std::atof( stringPairing.at(1).c_str() ) : 0.;
-
-    return {ft,in};
+    return parseFtInchPair( stringToParse, stringToParse, 1 );
   }
 
   //=========================================================================
   double Coordinate::convert2mm( const FtInchPair& ftInchPair ) {
 
-    std::string prefix = " Error in Coordinate::convert2mm: ";
-    if      ( ftInchPair.first > 0 && ftInchPair.second < 0. ) throw std::runtime_error( prefix+"Cannot have +ft and -in!" );
-    else if ( ftInchPair.first < 0 && ftInchPair.second < 0. ) throw std::runtime_error( prefix+"Cannot have -ft and -in!" );
+    // The message is only built on error, as this runs for every point
+    constexpr const char* prefix = " Error in Coordinate::convert2mm: ";
+    if      ( ftInchPair.first > 0 && ftInchPair.second < 0. ) throw std::runtime_error( std::string(prefix)+"Cannot have +ft and -in!" );
+    else if ( ftInchPair.first < 0 && ftInchPair.second < 0. ) throw std::runtime_error( std::string(prefix)+"Cannot have -ft and -in!" );
 
     double inches = ftInchPair.first*12;
     inches += sgn(ftInchPair.first)*ftInchPair.second;
@@ -1,12 +1,20 @@
 // Original author: Kyle Knoepfel
 
+#include "Utilities/inc/AnchorRegistry.hh"
 #include "Utilities/inc/Config.hh"
 #include "Utilities/inc/CoordinateCollection.hh"
-#include "Utilities/inc/Table.hh"
+#include "Utilities/inc/FixedLength.hh"
+#include "Utilities/inc/MappedFile.hh"
+#include "Utilities/inc/OutputFile.hh"
+#include "Utilities/inc/Profiler.hh"
+#include "Utilities/inc/SimpleConfigWriter.hh"
+#include "Utilities/inc/TextBuffer.hh"
 
 #include <algorithm>
+#include <bit>
 #include <cctype>
 #include <cmath>
+#include <cstring>
 #include <iterator>
 #include <sstream>
 #include <stdexcept>
@@ -17,31 +25,45 @@ using namespace worldDir;
 
 namespace {
 
-  bool hasDirt( std::string str ) {
-    return str.find("dirt.") != std::string::npos;
-  }
-
-  void replacementStream( std::ostringstream& os,
-                          const std::string& varprefix,
-                          const std::vector<std::size_t>& v ) {
-    if ( !v.empty() ) {
-      os << "vector<int>    " << varprefix << "replace   = { ";
-      std::size_t counter(0);
-      for ( std::size_t index : v ) {
-
-        if ( counter != v.size()-1 ) {
-          os << index << ", ";
-        }
-        else {
-          os << index << " }; " ;
-          os << std::endl;
-        }
+  // Four doubles handled as one GCC/Clang vector, which maps onto SSE2
+  // or AVX registers.  Each lane performs exactly the operations of the
+  // scalar expression, in the same order, so the results are
+  // bit-identical to coordinate-by-coordinate evaluation.
+  typedef double double4 __attribute__(( vector_size( 4*sizeof(double) ) ));
+
+  // abs = origin + R(phi)*rel for n points of one frame
+  void transformFrame( const double* relX, const double* relY,
+                       double* absX, double* absY, std::size_t n,
+                       double originX, double originY, double cosPhi, double sinPhi ) {
+
+    const double4 ox = { originX, originX, originX, originX };
+    const double4 oy = { originY, originY, originY, originY };
+    const double4 c  = { cosPhi , cosPhi , cosPhi , cosPhi  };
+    const double4 s  = { sinPhi , sinPhi , sinPhi , sinPhi  };
+
+    std::size_t k(0);
+    for ( ; k+4 <= n ; k += 4 ) {
+      double4 rx, ry;
+      std::memcpy( &rx, relX+k, sizeof(rx) );
+      std::memcpy( &ry, relY+k, sizeof(ry) );
+
+      const double4 ax = ox + c*rx - s*ry;
+      const double4 ay = oy + s*rx + c*ry;
+
+      std::memcpy( absX+k, &ax, sizeof(ax) );
+      std::memcpy( absY+k, &ay, sizeof(ay) );
+    }
 
-        ++counter;
-      }
+    for ( ; k < n ; ++k ) {
+      absX[k] = originX + cosPhi*relX[k] - sinPhi*relY[k];
+      absY[k] = originY + sinPhi*relX[k] + cosPhi*relY[k];
     }
   }
 
+  bool hasDirt( std::string str ) {
+    return str.find("dirt.") != std::string::npos;
+  }
+
 }
 
 
@@ -49,47 +71,89 @@ namespace util {
 
   //=========================================================================
   CoordinateCollection::CoordinateCollection( const std::string& inputFile,
-                                              const std::map<enum_type,Rep<double>>& worldCorners )
+                                              const std::map<enum_type,Rep<double>>& worldCorners,
+                                              const AnchorRegistry* anchors,
+                                              const bool fixedPoint )
     : inputFile_( inputFile )
+    , fixedPoint_( fixedPoint )
     , worldCorners_( worldCorners )
   {
-    Table<1> inputTable = loadTable<1>( inputFile_ );
-    unsigned counter(0);
-    for( const auto& row : inputTable.rawTable() ) {
-      if      ( counter == 0 ) volName_ = assignVolName( row.first );
-      else if ( counter == 1 ) height_  = assignHeight ( row.first );
-      else {
-        Coordinate coordStr ( row.first );
-        check_and_push_back( coordStr );
+    MappedLineReader reader = [&]{
+      UTIL_PROFILE_SCOPE( Load );
+      return MappedLineReader( inputFile_ );
+    }();
+
+    construct( [&]( std::string_view& entry ){ return reader.next( entry ); }, anchors );
+  }
+
+  //=========================================================================
+  CoordinateCollection::CoordinateCollection( std::string_view text,
+                                              const std::string& source,
+                                              const std::map<enum_type,Rep<double>>& worldCorners,
+                                              const AnchorRegistry* anchors,
+                                              const bool fixedPoint )
+    : inputFile_( source )
+    , fixedPoint_( fixedPoint )
+    , worldCorners_( worldCorners )
+  {
+    EntryReader reader( text );
+    construct( [&]( std::string_view& entry ){ return reader.next( entry ); }, anchors );
+  }
+
+  //=========================================================================
+  void CoordinateCollection::construct( const std::function<bool(std::string_view&)>& next, const AnchorRegistry* anchors ) {
+
+    // Parse all lines first, then resolve the references, so that the
+    // two stages can be timed separately
+    std::vector<Coordinate> parsed;
+    {
+      UTIL_PROFILE_SCOPE( Parse );
+      unsigned counter(0);
+      std::string_view entry;
+      while ( next( entry ) ) {
+        if      ( counter == 0 ) volName_ = assignVolName( entry );
+        else if ( counter == 1 ) height_  = assignHeight ( entry );
+        else parsed.emplace_back( entry );
+        ++counter;
       }
-      ++counter;
     }
+
+    UTIL_PROFILE_SCOPE( Resolve );
+    std::vector<std::size_t> refIndex;
+    refIndex.reserve( parsed.size() );
+    for ( auto& coord : parsed ) check_and_push_back( std::move( coord ), refIndex, anchors );
+
+    resolvePositions( refIndex, anchors );
   }
 
   //=========================================================================
-  std::string CoordinateCollection::assignVolName( const std::string& inputString ) {
+  std::string CoordinateCollection::assignVolName( std::string_view inputString ) {
     if ( inputString.find("VolName)") == std::string::npos )
       throw std::runtime_error("\nVolume name not specified in file: "+inputFile_+"\nFirst label must be:\n \"VolName)..a..string..\"");
 
     const std::size_t delimPos = inputString.find(")");
-    return inputString.substr(delimPos+1, inputString.length() );
+    return std::string( inputString.substr(delimPos+1) );
   }
 
   //=========================================================================
-  Coordinate::Rep<double> CoordinateCollection::assignHeight( const std::string& inputString ) {
+  Coordinate::Rep<double> CoordinateCollection::assignHeight( std::string_view inputString ) {
     if ( inputString.find("Height)") == std::string::npos )
       throw std::runtime_error("\nHeight of solid not specified in file: "+inputFile_+"\nSecond label must be:\n \"Height)...,...\"");
 
-    return Coordinate( inputString ).getCoordRel();
+    const Coordinate height( inputString );
+    if ( fixedPoint_ ) {
+      if ( const auto fixed = toFixed( height.getCoordStd() ) ) return { fixedToMm( fixed->at(0) ), fixedToMm( fixed->at(1) ) };
+    }
+    return height.getCoordRel();
   }
 
   //=========================================================================
-  void CoordinateCollection::check_and_push_back( Coordinate& coord ) {
-
-    const auto insertTest = keyList_.insert( coord.label() );
+  void CoordinateCollection::check_and_push_back( Coordinate&& coord,
+                                                  std::vector<std::size_t>& refIndex,
+                                                  const AnchorRegistry* anchors ) {
 
-    if ( !insertTest.second ) {
-      throw std::runtime_error("Label << "+coord.label()+" >> already used!");
+    if ( !coord.label().empty() && coord.label().front() == AnchorRegistry::prefix ) {
+      throw std::runtime_error("Label << "+coord.label()+" >> starts with '@', which is reserved for anchors!");
     }
 
     // Get reference label
@@ -100,45 +164,213 @@ namespace util {
     if ( coordList_.empty() ) coord.setRotation(0.);
     else if ( coord.rot() < -360 ) coord.setRotation( coordList_.back().rot() );
 
-    if ( keyList_.find( coord.refLabel() ) == std::end(keyList_) ) {
+    // Add the anchor before the coordinate's own label is indexed
+    const std::string& refLabel = coord.refLabel();
+    if ( !refLabel.empty() && refLabel.front() == AnchorRegistry::prefix &&
+         labelIndex_.find( refLabel ) == std::end(labelIndex_) ) {
+      const Rep<double>* anchor = anchors != nullptr ? anchors->find( std::string_view( refLabel ).substr(1) ) : nullptr;
+      if ( anchor == nullptr ) {
+        throw std::runtime_error("Anchor << "+refLabel+" >> does not exist"+( anchors != nullptr ? " in "+anchors->filename() : std::string(", no anchors file given") )+"!");
+      }
+      labelIndex_.emplace( refLabel, coordList_.size() );
+      refIndex.push_back( coordList_.size() );
+      coordList_.emplace_back( *anchor, refLabel, worldDir::none, false, false );
+      coordList_.back().setRefLabel( refLabel );
+    }
+
+    const auto insertTest = labelIndex_.emplace( coord.label(), coordList_.size() );
+
+    if ( !insertTest.second ) {
+      throw std::runtime_error("Label << "+coord.label()+" >> already used!");
+    }
+
+    if ( labelIndex_.find( coord.refLabel() ) == std::end(labelIndex_) ) {
       throw std::runtime_error("Reference label << "+coord.refLabel()+" >> does not exist yet!");
     }
 
-    // Get origin
-    if ( !coordList_.empty() ) {
-      const auto& origin = getReferenceCoordinate( coord.refLabel() );
-      const double phi   = coord.rot()*M_PI/180;
-      coord.setAbsX( origin.x() + std::cos( phi )*coord.getCoordRel().at(0) - std::sin( phi )*coord.getCoordRel().at(1) );
-      coord.setAbsY( origin.y() + std::sin( phi )*coord.getCoordRel().at(0) + std::cos( phi )*coord.getCoordRel().at(1) );
+    // The first coordinate is its own origin
+    const std::size_t ref = coordList_.empty() ? 0 : getReferenceIndex( coord.refLabel() );
+
+    refIndex.push_back( ref );
+    coordList_.push_back( std::move( coord ) );
+  }
+
+  //============================================
+  std::size_t CoordinateCollection::getReferenceIndex( const std::string& refLabel ) const {
+
+    // The index of a label is reserved before its coordinate is added,
+    // so a coordinate referring to itself is not found either
+    auto match = labelIndex_.find( refLabel );
+
+    if ( match == std::end( labelIndex_ ) || match->second >= coordList_.size() )
+      throw std::runtime_error("Reference coordinate << "+refLabel+" >> notFound!");
+
+    return match->second;
+  }
+
+  //============================================
+  void CoordinateCollection::resolvePositions( const std::vector<std::size_t>& refIndex, const AnchorRegistry* anchors ) {
+
+    const std::size_t n = coordList_.size();
+
+    std::vector<double> relX( n ), relY( n ), absX( n ), absY( n );
+    for ( std::size_t i(0) ; i < n ; ++i ) {
+      relX[i] = coordList_[i].getCoordRel().at(0);
+      relY[i] = coordList_[i].getCoordRel().at(1);
     }
-    else {
-      coord.setAbsX( coord.getCoordRel().at(0) );
-      coord.setAbsY( coord.getCoordRel().at(1) );
+
+    // In fixed-point mode, the exact relative positions (anchors have
+    // their absolute one), and the exact absolute positions found so far
+    std::vector<Rep<FixedLength>> relFixed, absFixed;
+    std::vector<std::uint8_t>     relExact, absExact;
+    if ( fixedPoint_ ) {
+      relFixed.resize( n );
+      absFixed.resize( n );
+      relExact.assign( n, 0 );
+      absExact.assign( n, 0 );
+      for ( std::size_t i(0) ; i < n ; ++i ) {
+        const Coordinate& coord = coordList_[i];
+        std::optional<Rep<FixedLength>> fixed;
+        if ( !coord.label().empty() && coord.label().front() == AnchorRegistry::prefix ) {
+          const Rep<FixedLength>* anchor = anchors != nullptr ? anchors->findFixed( std::string_view( coord.label() ).substr(1) ) : nullptr;
+          if ( anchor != nullptr ) fixed = *anchor;
+        }
+        else fixed = toFixed( coord.getCoordStd() );
+        if ( !fixed ) continue;
+        relFixed[i] = *fixed;
+        relExact[i] = 1;
+      }
     }
 
-    // Add coordinate to boundary list
-    if ( coord.worldBoundary() != worldDir::none ) boundaryList_.push_back( coord );
+    // The first coordinate and the anchors are their own reference,
+    // their relative position is absolute
+    std::vector<std::size_t> order;
+    order.reserve( n );
+    for ( std::size_t i(0) ; i < n ; ++i ) {
+      if ( refIndex[i] != i ) { order.push_back( i ); continue; }
+      absX[i] = relX[i];
+      absY[i] = relY[i];
+      if ( fixedPoint_ && relExact[i] ) {
+        absFixed[i] = relFixed[i];
+        absExact[i] = 1;
+        absX[i] = fixedToMm( absFixed[i].at(0) );
+        absY[i] = fixedToMm( absFixed[i].at(1) );
+      }
+    }
 
-    coordList_.push_back( coord );
+    // Group the coordinates into frames, i.e. by (reference, rotation),
+    // ordering the frames by reference index.  Every reference precedes
+    // the coordinates that use it, so by the time a frame is reached
+    // its reference belongs to a frame that has already been resolved.
+    // Rotations are compared bitwise so that 0 and -0 stay apart.
+
+    auto frameKey = [&]( std::size_t i ){
+      return std::make_pair( refIndex[i], std::bit_cast<std::uint64_t>( coordList_[i].rot() ) );
+    };
+    std::stable_sort( order.begin(), order.end(),
+                      [&]( std::size_t a, std::size_t b ){ return frameKey(a) < frameKey(b); } );
+
+    // Gather each frame into contiguous arrays, transform it as one
+    // batch with a single sin/cos evaluation, and scatter it back.  In
+    // exact frames (exact reference, rotation by quarter turns) the
+    // points with exact relative positions are integer sums, converted
+    // to mm once, and are left out of the batch; the other points of
+    // the frame are transformed from the converted origin.
+    std::vector<std::size_t> batch;
+    std::vector<double>      batchRelX, batchRelY, batchAbsX, batchAbsY;
+    for ( std::size_t begin(0) ; begin < order.size() ; ) {
+      std::size_t end = begin+1;
+      while ( end < order.size() && frameKey( order[end] ) == frameKey( order[begin] ) ) ++end;
+
+      const std::size_t first = order[begin];
+      const std::size_t ref   = refIndex[first];
+      const std::optional<int> turns = fixedPoint_ && absExact[ref] ? quarterTurns( coordList_[first].rot() ) : std::nullopt;
+
+      batch.clear(); batchRelX.clear(); batchRelY.clear();
+      for ( std::size_t k = begin ; k < end ; ++k ) {
+        const std::size_t i = order[k];
+        if ( turns && relExact[i] ) {
+          const Rep<FixedLength> rotated = rotateFixed( relFixed[i], *turns );
+          absFixed[i] = { absFixed[ref].at(0)+rotated.at(0), absFixed[ref].at(1)+rotated.at(1) };
+          absExact[i] = 1;
+          absX[i] = fixedToMm( absFixed[i].at(0) );
+          absY[i] = fixedToMm( absFixed[i].at(1) );
+          continue;
+        }
+        batch.push_back( i );
+        batchRelX.push_back( relX[i] );
+        batchRelY.push_back( relY[i] );
+      }
+
+      if ( !batch.empty() ) {
+        const double phi = coordList_[first].rot()*M_PI/180;
+        batchAbsX.resize( batch.size() );
+        batchAbsY.resize( batch.size() );
+        transformFrame( batchRelX.data(), batchRelY.data(), batchAbsX.data(), batchAbsY.data(), batch.size(),
+                        absX[ref], absY[ref], std::cos( phi ), std::sin( phi ) );
+        for ( std::size_t k(0) ; k < batch.size() ; ++k ) {
+          absX[ batch[k] ] = batchAbsX[k];
+          absY[ batch[k] ] = batchAbsY[k];
+        }
+      }
+
+      begin = end;
+    }
+
+    // Store the positions and fill the per-vertex arrays
+    for ( std::size_t i(0) ; i < n ; ++i ) {
+      Coordinate& coord = coordList_[i];
+      coord.setAbsX( absX[i] );
+      coord.setAbsY( absY[i] );
+
+      // Add coordinate to boundary list
+      if ( coord.worldBoundary() != worldDir::none ) boundaryList_.push_back( coord );
+
+      indexVertex( i );
+    }
 
   }
 
   //============================================
-  Coordinate CoordinateCollection::getReferenceCoordinate( const std::string& refLabel ) const {
+  void CoordinateCollection::appendVertex( Coordinate&& coord ) {
+    coordList_.push_back( std::move( coord ) );
+    indexVertex( coordList_.size()-1 );
+  }
 
-    auto match  = std::find_if( std::begin( coordList_ )
-                                ,std::end( coordList_)
-                                ,[&](const Coordinate& cs){ return !cs.label().compare( refLabel ); } );
+  //============================================
+  void CoordinateCollection::indexVertex( std::size_t i ) {
 
-    if ( match == std::end( coordList_ ) )
-      throw std::runtime_error("Reference coordinate << "+refLabel+" >> notFound!");
+    const Coordinate& coord = coordList_[i];
+
+    std::uint8_t flags(0);
+    if ( coord.drawFlag()                       ) flags |= Draw;
+    if ( coord.isOutline()                      ) flags |= Outline;
+    if ( coord.worldBoundary() != worldDir::none) flags |= Boundary;
+
+    x_    .push_back( coord.x() );
+    y_    .push_back( coord.y() );
+    flags_.push_back( flags     );
+
+    // The first coordinate is the reference point, never part of the polygon
+    if ( i != 0 && (flags & Draw) ) {
+      drawn_.x.push_back( coord.x() );
+      drawn_.y.push_back( coord.y() );
+      drawn_.index.push_back( i );
+
+      if ( flags & Outline ) {
+        outline_.x.push_back( coord.x() );
+        outline_.y.push_back( coord.y() );
+        outline_.index.push_back( i );
+      }
+    }
 
-    return *match;
   }
 
   //============================================
   bool CoordinateCollection::addWorldBoundaries( const bool verbose ) {
 
+    UTIL_PROFILE_SCOPE( Boundaries );
+
     if ( boundaryList_.size() < 2 ) {
       if ( verbose ) std::cout << " Not enough boundary points present " << std::endl;
       return false;
@@ -180,9 +412,7 @@ namespace util {
 
     }
 
-    std::copy( wallCoords.begin(),
-               wallCoords.end(),
-               std::back_inserter( coordList_ ) );
+    for ( auto& coord : wallCoords ) appendVertex( std::move( coord ) );
 
     return true;
 
@@ -190,128 +420,104 @@ namespace util {
 
 
   //============================================
-  void CoordinateCollection::printSimpleConfigFile( Config& config, const std::string& dir, const bool outline ) const {
+  SimpleConfigVolume CoordinateCollection::simpleConfigVolume( const bool outline ) const {
+
+    SimpleConfigVolume volume;
 
     // Tokenize
     typedef boost::tokenizer<boost::char_separator<char>> tokenizer;
     boost::char_separator<char> sep(".");
     tokenizer tokens(volName_, sep);
 
-    std::string name;
     int tokenCounter(0);
     for ( auto& token : tokens ) {
       // Capitalize first letter
       std::string tmp (token); // need to form a temporary since token iterators are const.
       if ( tokenCounter ) tmp[0] = std::toupper( tmp[0] );
       ++tokenCounter;
-      name += tmp;
+      volume.name += tmp;
     }
 
-    const std::string filename  = dir+name+".txt";
-    const std::string includefilename = "Mu2eG4/geom/bldg/"+name+".txt";
-    const std::string varprefix = hasDirt( volName_ ) ? volName_ : "building."+volName_;
-    const std::string material  = hasDirt( volName_ ) ? "MBOverburden" : "CONCRETE_MARS";
+    volume.prefix   = hasDirt( volName_ ) ? volName_ : "building."+volName_;
+    volume.material = hasDirt( volName_ ) ? "MBOverburden" : "CONCRETE_MARS";
 
-    // Fill master config
-    auto& fileList   = hasDirt( volName_ ) ? config.dirtFiles    : config.bldgFiles;
-    auto& prefixList = hasDirt( volName_ ) ? config.dirtPrefixes : config.bldgPrefixes;
-
-    fileList  .push_back( "#include \""+includefilename+"\"" );
-    prefixList.push_back( varprefix );
-
-    std::fstream fs;
-    fs.open( filename.data(), std::fstream::out );
-
-    const double yHalfThickness = 0.5*(height_.at(1)-height_.at(0));
-    const double yOffset        = height_.at(0) + yHalfThickness;
-
-    fs << R"(// SimpleConfig geometry file automatically produced for original file: )" << std::endl;
-    fs << "//" << std::endl;
-    fs << "//   " << inputFile_ << std::endl;
-    fs << std::endl;
-    fs << "string " << varprefix << ".name     = \"" << name << "\";" << std::endl;
-    fs << std::endl;
-    fs << "string " << varprefix << ".material = \"" << material << "\";" << std::endl;
-    fs << std::endl;
-    fs << "double " << varprefix << ".offsetFromMu2eOrigin.x   = " << Xoffset << ";" << std::endl;
-    fs << "double " << varprefix << ".offsetFromFloorSurface.y = " << yOffset << ";" << std::endl;
-    fs << "double " << varprefix << ".offsetFromMu2eOrigin.z   = " << Zoffset << ";" << std::endl;
-    fs << std::endl;
-    fs << "double " << varprefix << ".yHalfThickness           = " << yHalfThickness << ";" << std::endl;
-    fs << std::endl;
-
-    std::vector<std::size_t> xReplaceV;
-    std::vector<std::size_t> yReplaceV;
-
-    std::ostringstream xstr;
-    std::ostringstream ystr;
-    // make list
-    xstr << R"(vector<double> )" << varprefix << ".xPositions = {" << std::endl;
-    ystr << R"(vector<double> )" << varprefix << ".yPositions = {" << std::endl;
-
-    std::size_t indexCounter(0);
-    for ( std::size_t i(0) ;  i < coordList_.size() ; ++i ) {
-      const auto& coord = coordList_.at(i);
-
-      if ( i == 0 || !coord.drawFlag()   ) continue;
-      if ( outline && !coord.isOutline() ) continue;
-
-      xstr << "  " << coord.x();
-      ystr << "  " << coord.y();
-      if ( i != coordList_.size()-1 ) { xstr << ","; ystr << ","; }
-      xstr << R"(   // )" << coord.label() << std::endl;
-      ystr << R"(   // )" << coord.label() << std::endl;
-
-      // Determine replacement for actual Mu2e world boundaries
-      if ( coord.label().find("corner") != std::string::npos ) {
-        xReplaceV.push_back( indexCounter );
-        yReplaceV.push_back( indexCounter );
+    volume.yMin = height_.at(0);
+    volume.yMax = height_.at(1);
+
+    volume.yHalfThickness          = 0.5*(height_.at(1)-height_.at(0));
+    volume.offsetFromMu2eOriginX   = Xoffset;
+    volume.offsetFromFloorSurfaceY = height_.at(0) + volume.yHalfThickness;
+    volume.offsetFromMu2eOriginZ   = Zoffset;
+
+    const PolygonView polygon = outline ? outlinePolygon() : drawnPolygon();
+    volume.x.assign( polygon.x.begin(), polygon.x.end() );
+    volume.y.assign( polygon.y.begin(), polygon.y.end() );
+
+    // Determine replacement for actual Mu2e world boundaries
+    for ( std::size_t j(0) ; j < polygon.size() ; ++j ) {
+      const std::string& label = coordList_[ polygon.index[j] ].label();
+
+      if ( label.find("corner") != std::string::npos ) {
+        volume.xReplace.push_back( j );
+        volume.yReplace.push_back( j );
       }
-      if ( coord.label().find("_to_N")  != std::string::npos ||
-           coord.label().find("_to_S")  != std::string::npos ) {
-        yReplaceV.push_back( indexCounter );
+      if ( label.find("_to_N")  != std::string::npos ||
+           label.find("_to_S")  != std::string::npos ) {
+        volume.yReplace.push_back( j );
       }
-      if ( coord.label().find("_to_E")  != std::string::npos ||
-           coord.label().find("_to_W")  != std::string::npos ) {
-        xReplaceV.push_back( indexCounter );
+      if ( label.find("_to_E")  != std::string::npos ||
+           label.find("_to_W")  != std::string::npos ) {
+        volume.xReplace.push_back( j );
       }
-
-      ++indexCounter;
     }
-    xstr <<  R"(};)" << std::endl;
-    ystr <<  R"(};)" << std::endl;
 
-    // Having trouble getting the move semantics to work for
-    // ostringstream (perhaps it's still a bug in the compiler?), so
-    // passing the oss by reference.
+    return volume;
+  }
 
-    std::ostringstream xReplaceOS; replacementStream( xReplaceOS, varprefix+".x", xReplaceV );
-    std::ostringstream yReplaceOS; replacementStream( yReplaceOS, varprefix+".y", yReplaceV );
+  //============================================
+  SimpleConfigVolume CoordinateCollection::printSimpleConfigFile( Config& config, const std::string& dir, const bool outline ) const {
 
-    fs << xReplaceOS.str();
-    fs << xstr.str() ;
+    UTIL_PROFILE_SCOPE( Emit );
 
-    fs << std::endl;
+    SimpleConfigVolume volume = simpleConfigVolume( outline );
 
-    fs << yReplaceOS.str();
-    fs << ystr.str() ;
+    // Fill master config
+    addSimpleConfigFile( config, volume, dir );
 
-    fs << std::endl;
-    fs << R"(// Local Variables:)" << std::endl;
-    fs << R"(// mode:c++)"         << std::endl;
-    fs << R"(// End:)"             << std::endl;
+    // Assemble the file in one buffer (reused across the files written
+    // by a thread) and write it out only if its bytes changed
+    thread_local TextBuffer fs;
+    fs.clear();
+    formatSimpleConfigFile( fs, volume, outline );
 
-    fs.close();
+    writeIfChanged( dir+volume.name+".txt", fs.view() );
 
+    return volume;
+  }
+
+  //============================================
+  void CoordinateCollection::formatSimpleConfigFile( TextBuffer& fs, const SimpleConfigVolume& volume, const bool outline ) const {
+
+    thread_local TextBuffer comment;
+    comment.clear();
+    comment << "// SimpleConfig geometry file automatically produced for original file: \n";
+    comment << "//\n";
+    comment << "//   " << inputFile_ << '\n';
+
+    // Each position is followed by the label of its vertex; every one
+    // but the last coordinate of the whole collection has a comma
+    const PolygonView polygon = outline ? outlinePolygon() : drawnPolygon();
+    util::formatSimpleConfigFile( fs, volume, comment.view(), [&]( TextBuffer& os, std::size_t j ){
+        if ( polygon.index[j] != coordList_.size()-1 ) os << ',';
+        os << "   // " << coordList_[ polygon.index[j] ].label();
+      } );
   }
 
   //============================================
   bool CoordinateCollection::hasOuterPoints( const CoordinateCollection& ccoll ) {
 
-    unsigned nPoints(0);
-    for ( const auto& coord : ccoll.coordinates() ) {
-      if ( coord.isOutline() ) ++nPoints;
-    }
+    const auto nPoints = std::count_if( ccoll.flags_.begin(), ccoll.flags_.end(),
+                                        [](std::uint8_t flags){ return flags & Outline; } );
     return nPoints > 1 ? true : false;
 
   }
@@ -365,7 +571,7 @@ namespace util {
     std::vector<worldDir::enum_type> bounds {{ type1, type2 }};
     std::sort( bounds.begin(), bounds.end() );
 
-    const Rep<double>* corner;
+    const Rep<double>* corner = nullptr;
 
     std::string label;
     if      ( std::equal( bounds.begin(), bounds.end(), nw.begin() ) ) { corner = &worldCorner(NW); label = "NWcorner"; }
@@ -373,6 +579,8 @@ namespace util {
     else if ( std::equal( bounds.begin(), bounds.end(), se.begin() ) ) { corner = &worldCorner(SE); label = "SEcorner"; }
     else if ( std::equal( bounds.begin(), bounds.end(), sw.begin() ) ) { corner = &worldCorner(SW); label = "SWcorner"; }
 
+    if ( corner == nullptr )
+      throw std::runtime_error("\nNo world corner between boundaries "+std::to_string(type1)+" and "+std::to_string(type2)+" in file: "+inputFile_);
 
     return Coordinate( *corner, label, worldDir::none, true, true );
   }
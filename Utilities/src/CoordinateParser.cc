@@ -0,0 +1,243 @@
+// Single-pass, allocation-free parser for .ccl coordinate lines.
+
+#include "Utilities/inc/CoordinateParser.hh"
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace {
+
+  constexpr std::size_t npos = std::string_view::npos;
+
+  // Character class of each byte: 0 for ordinary characters, otherwise
+  // the slot in which the position of its first occurrence is kept
+  enum Delimiter : std::uint8_t { None, LabelDelim, WallLeftDelim, WallRightDelim,
+                                  RefLeftDelim, RefRightDelim, RotDelim, CommaDelim, nDelimiters };
+
+  constexpr std::array<std::uint8_t,256> makeDelimiterTable() {
+    std::array<std::uint8_t,256> table {};
+    table[')'] = LabelDelim;
+    table['['] = WallLeftDelim;
+    table[']'] = WallRightDelim;
+    table['<'] = RefLeftDelim;
+    table['>'] = RefRightDelim;
+    table['|'] = RotDelim;
+    table[','] = CommaDelim;
+    return table;
+  }
+
+  constexpr std::array<std::uint8_t,256> delimiterTable = makeDelimiterTable();
+
+  [[noreturn]] void parseError( std::string_view line, std::size_t column, const std::string& what ) {
+    throw std::runtime_error( "Coordinate \""+std::string(line)+"\", column "+std::to_string(column)+": "+what );
+  }
+
+  // Equivalent to text.find("//") != npos, without the generic search
+  bool containsCommentMarker( std::string_view text ) {
+    for ( std::size_t i(1) ; i < text.size() ; ++i ) {
+      if ( text[i] == '/' && text[i-1] == '/' ) return true;
+    }
+    return false;
+  }
+
+  // from_chars does not accept a leading '+', atoi/atof did
+  std::string_view stripPlus( std::string_view text ) {
+    if ( !text.empty() && text.front() == '+' ) text.remove_prefix(1);
+    return text;
+  }
+
+  // Exact fast path for plain decimals ("-12.345"): when the digits fit
+  // in a 53-bit mantissa and the power of ten is exactly representable,
+  // a single IEEE division gives the correctly-rounded result, i.e. the
+  // same value as from_chars/strtod.  Returns false if not applicable.
+  bool parseSimpleDecimal( std::string_view text, double& value ) {
+    static constexpr double powersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+                                             1e11, 1e12, 1e13, 1e14, 1e15 };
+    std::size_t i(0);
+    const bool negative = !text.empty() && text.front() == '-';
+    if ( negative ) ++i;
+
+    std::uint64_t mantissa(0);
+    std::size_t   nDigits(0), nFraction(0);
+    bool          seenPoint(false);
+    for ( ; i < text.size() ; ++i ) {
+      const char c = text[i];
+      if ( c >= '0' && c <= '9' ) {
+        mantissa = mantissa*10 + (c-'0');
+        if ( ++nDigits > 15 ) return false;
+        if ( seenPoint ) ++nFraction;
+      }
+      else if ( c == '.' && !seenPoint ) seenPoint = true;
+      else return false;
+    }
+    if ( nDigits == 0 ) return false;
+
+    value = static_cast<double>( mantissa ) / powersOf10[nFraction];
+    if ( negative ) value = -value;
+    return true;
+  }
+
+  template <typename T>
+  T parseNumber( std::string_view text, std::string_view line, std::size_t column, const char* what ) {
+    const std::string_view digits = stripPlus( text );
+    T value {};
+    if constexpr ( std::is_same_v<T,double> ) {
+      if ( parseSimpleDecimal( digits, value ) ) return value;
+    }
+    const auto result = std::from_chars( digits.data(), digits.data()+digits.size(), value );
+    if ( result.ec != std::errc() || result.ptr != digits.data()+digits.size() || digits.empty() ) {
+      const std::size_t bad = ( result.ec != std::errc() ) ? 0 : result.ptr-digits.data();
+      parseError( line, column+(text.size()-digits.size())+bad,
+                  "cannot read "+std::string(what)+" from \""+std::string(text)+"\"" );
+    }
+    return value;
+  }
+
+}
+
+namespace util {
+
+  //=========================================================================
+  Coordinate::FtInchPair parseFtInchPair( std::string_view text,
+                                          std::string_view line,
+                                          std::size_t column ) {
+
+    // Feet: an optionally signed integer, terminated by ':' or the end
+    std::size_t i(0);
+    const bool negative = !text.empty() && text.front() == '-';
+    if ( !text.empty() && ( text.front() == '-' || text.front() == '+' ) ) ++i;
+
+    const std::size_t digitsBegin = i;
+    int ft(0);
+    for ( ; i < text.size() && text[i] >= '0' && text[i] <= '9' ; ++i ) {
+      if ( i-digitsBegin == 9 ) parseError( line, column+i, "feet out of range in \""+std::string(text)+"\"" );
+      ft = ft*10 + (text[i]-'0');
+    }
+    if ( negative ) ft = -ft;
+
+    if ( i == digitsBegin && i != 0 )
+      parseError( line, column+i, "cannot read feet from \""+std::string(text)+"\"" );
+    if ( i == text.size() ) return {ft,0.};
+    if ( text[i] != ':' )
+      parseError( line, column+i, "unexpected character '"+std::string(1,text[i])+"' in \""+std::string(text)+"\"" );
+
+    // Inches: whatever follows the ':'
+    const std::string_view inStr = text.substr( i+1 );
+    const double in = inStr.empty() ? 0. : parseNumber<double>( inStr, line, column+i+1, "inches" );
+
+    return {ft,in};
+  }
+
+  //=========================================================================
+  void parseCoordinate( std::string_view line, ParsedCoordinate& result ) {
+
+    result = ParsedCoordinate();
+
+    // Locate the first occurrence of every delimiter in one pass.  The
+    // line is scanned backwards so that the slot of each delimiter ends
+    // up holding its first position without any branching; slot 0
+    // collects the ordinary characters and is ignored.
+    std::array<std::size_t,nDelimiters> first;
+    first.fill( npos );
+    for ( std::size_t i = line.size() ; i-- > 0 ; ) {
+      first[ delimiterTable[ static_cast<unsigned char>( line[i] ) ] ] = i;
+    }
+
+    const std::size_t labelDelim     = first[LabelDelim];
+    const std::size_t wallLeftDelim  = first[WallLeftDelim];
+    const std::size_t wallRightDelim = first[WallRightDelim];
+    const std::size_t refLeftDelim   = first[RefLeftDelim];
+    const std::size_t refRightDelim  = first[RefRightDelim];
+    const std::size_t rotDelim       = first[RotDelim];
+    const std::size_t commaDelim     = first[CommaDelim];
+
+    // Get label
+    if ( labelDelim == npos ) parseError( line, line.size()+1, "label not specified, missing ')'" );
+    result.label = line.substr( 0, labelDelim );
+
+    // Check if draw flag should be set
+    if ( containsCommentMarker( result.label ) ) {
+      result.draw  = false;
+      result.label = result.label.substr( result.label.find_last_of('/')+1 );
+    }
+
+    // Check if coordinate represents point on the outside (as
+    // std::islower in the "C" locale)
+    result.isOut = !result.label.empty() && result.label.front() >= 'a' && result.label.front() <= 'z';
+
+    // Make sure there's an ordered pair
+    if ( commaDelim == npos )
+      parseError( line, line.size()+1, "label << "+std::string(result.label)+" >> has no ordered pair!  You probably forgot the ',' character." );
+
+    // Get origin reference
+    const bool newOrigin = ( refLeftDelim != npos && refRightDelim != npos );
+    const bool oldOrigin = ( refLeftDelim == npos && refRightDelim == npos );
+    if ( !newOrigin && !oldOrigin )
+      parseError( line, ( refLeftDelim != npos ? refLeftDelim : refRightDelim )+1, "missing \"<\" or \">\"" );
+    if ( newOrigin && refRightDelim < refLeftDelim )
+      parseError( line, refRightDelim+1, "\">\" before \"<\"" );
+
+    // Get wall reference
+    const bool yesWallRef = ( wallLeftDelim != npos && wallRightDelim != npos );
+    const bool noWallRef  = ( wallLeftDelim == npos && wallRightDelim == npos );
+    if ( !yesWallRef && !noWallRef )
+      parseError( line, ( wallLeftDelim != npos ? wallLeftDelim : wallRightDelim )+1, "missing \"[\" or \"]\"" );
+    if (  yesWallRef && !newOrigin )
+      parseError( line, wallLeftDelim+1, "must specify reference point \"<something_here>\" when adding wall reference!" );
+
+    if ( yesWallRef ) {
+      const std::string_view wall = ( wallRightDelim > wallLeftDelim ) ?
+        line.substr( wallLeftDelim+1, wallRightDelim-wallLeftDelim-1 ) : std::string_view();
+      if ( wall.size() != 1 ) parseError( line, wallLeftDelim+2, "wall option << "+std::string(wall)+" >> is not supported!" );
+      switch( wall.front() ) {
+      case 'N' : result.worldBoundary = worldDir::N; break;
+      case 'E' : result.worldBoundary = worldDir::E; break;
+      case 'S' : result.worldBoundary = worldDir::S; break;
+      case 'W' : result.worldBoundary = worldDir::W; break;
+      default  : parseError( line, wallLeftDelim+2, "wall option << "+std::string(wall)+" >> is not supported!" );
+      }
+    }
+
+    // Check for rotation, which must sit inside the reference brackets
+    if ( rotDelim != npos && ( !newOrigin || rotDelim < refLeftDelim || rotDelim > refRightDelim ) )
+      parseError( line, rotDelim+1, "rotation \"|\" must be inside \"<...>\"" );
+
+    result.hasRotation = ( rotDelim != npos ) && ( refRightDelim-rotDelim-1 != 0 );
+
+    // Reassign reference origin and rotation as necessary
+    if ( result.hasRotation ) {
+      result.rotation = parseNumber<double>( line.substr( rotDelim+1, refRightDelim-rotDelim-1 ), line, rotDelim+2, "rotation" );
+    }
+    if ( newOrigin ) {
+      const std::size_t refEnd = ( rotDelim != npos ) ? rotDelim : refRightDelim;
+      result.refLabel = line.substr( refLeftDelim+1, refEnd-refLeftDelim-1 );
+    }
+
+    // Get coordinate string
+    const std::size_t coordBegin = ( refRightDelim != npos ? refRightDelim : labelDelim )+1;
+    result.coordStr = line.substr( coordBegin );
+
+    if ( result.coordStr.empty() )
+      parseError( line, coordBegin+1, "no coordinate exists for label << "+std::string(result.label)+" >>!" );
+
+    // Parse coordinates; a second ',' is caught as an invalid character
+    // when reading the y component
+    const std::size_t comma = ( commaDelim >= coordBegin ) ? commaDelim-coordBegin : result.coordStr.find(',');
+    if ( comma == npos )
+      parseError( line, coordBegin+1, "ordered pair must follow the reference, missing ','" );
+
+    const std::string_view xStr = result.coordStr.substr( 0, comma );
+    const std::string_view yStr = result.coordStr.substr( comma+1 );
+
+    if ( yStr.empty() )
+      parseError( line, coordBegin+comma+2, "missing second coordinate of ordered pair" );
+
+    result.coordStd.at(0) = parseFtInchPair( xStr, line, coordBegin+1 );
+    result.coordStd.at(1) = parseFtInchPair( yStr, line, coordBegin+comma+2 );
+  }
+
+} // end of namespace util
@@ -0,0 +1,140 @@
+// Change notification for a directory of .ccl files.
+
+#include "Utilities/inc/DirectoryWatcher.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <set>
+#include <stdexcept>
+
+#include <dirent.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+  // How long to wait for further events of the same save
+  constexpr int settleMs = 5;
+
+  constexpr uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE;
+
+  bool endsWith( const std::string& str, const std::string& suffix ) {
+    return str.size() >= suffix.size() &&
+      str.compare( str.size()-suffix.size(), suffix.size(), suffix ) == 0;
+  }
+
+}
+
+namespace util {
+
+  //=========================================================================
+  DirectoryWatcher::DirectoryWatcher( const std::string& directory, const std::string& suffix )
+    : directory_( directory )
+    , suffix_( suffix )
+    , fd_( ::inotify_init1( IN_CLOEXEC ) )
+  {
+    if ( fd_ < 0 )
+      throw std::runtime_error( "Cannot set up inotify ("+std::string( std::strerror( errno ) )+")" );
+
+    watch_ = ::inotify_add_watch( fd_, directory_.c_str(), mask );
+    if ( watch_ < 0 ) {
+      const int error = errno;
+      ::close( fd_ );
+      throw std::runtime_error( "Cannot watch directory: "+directory_+" ("+std::strerror( error )+")" );
+    }
+  }
+
+  //=========================================================================
+  void DirectoryWatcher::watchFile( const std::string& file ) {
+
+    // Watch the directory, so that saves through a temporary file are seen
+    const std::size_t slash     = file.rfind( '/' );
+    const std::string directory = slash == std::string::npos ? "." : file.substr( 0, slash+1 );
+    const std::string name      = slash == std::string::npos ? file : file.substr( slash+1 );
+
+    const int watch = ::inotify_add_watch( fd_, directory.c_str(), mask );
+    if ( watch < 0 )
+      throw std::runtime_error( "Cannot watch directory: "+directory+" ("+std::strerror( errno )+")" );
+    files_[ { watch, name } ] = file;
+  }
+
+  //=========================================================================
+  DirectoryWatcher::~DirectoryWatcher() {
+    ::close( fd_ );
+  }
+
+  //=========================================================================
+  std::string DirectoryWatcher::path( const std::string& name ) const {
+    if ( directory_.empty() || directory_.back() == '/' ) return directory_+name;
+    return directory_+"/"+name;
+  }
+
+  //=========================================================================
+  std::vector<std::string> DirectoryWatcher::files() const {
+
+    DIR* dir = ::opendir( directory_.c_str() );
+    if ( dir == nullptr )
+      throw std::runtime_error( "Cannot read directory: "+directory_+" ("+std::strerror( errno )+")" );
+
+    std::vector<std::string> names;
+    while ( const dirent* entry = ::readdir( dir ) ) {
+      const std::string name( entry->d_name );
+      if ( endsWith( name, suffix_ ) ) names.push_back( path( name ) );
+    }
+    ::closedir( dir );
+
+    std::sort( names.begin(), names.end() );
+    return names;
+  }
+
+  //=========================================================================
+  DirectoryWatcher::Changes DirectoryWatcher::wait() {
+
+    std::set<std::string> touched;
+
+    alignas(inotify_event) char buffer[ 64*1024 ];
+    int timeout = -1;   // block for the first event, then let the batch settle
+    for (;;) {
+      pollfd pfd { fd_, POLLIN, 0 };
+      const int ready = ::poll( &pfd, 1, timeout );
+      if ( ready < 0 && errno == EINTR ) continue;
+      if ( ready < 0 )
+        throw std::runtime_error( "Cannot poll inotify ("+std::string( std::strerror( errno ) )+")" );
+      if ( ready == 0 ) {
+        if ( !touched.empty() ) break;
+        timeout = -1;
+        continue;
+      }
+
+      const ssize_t length = ::read( fd_, buffer, sizeof(buffer) );
+      if ( length < 0 && errno == EINTR ) continue;
+      if ( length < 0 )
+        throw std::runtime_error( "Cannot read inotify events ("+std::string( std::strerror( errno ) )+")" );
+
+      for ( ssize_t pos(0) ; pos < length ; ) {
+        const inotify_event* event = reinterpret_cast<const inotify_event*>( buffer+pos );
+        if ( event->len > 0 ) {
+          const std::string name( event->name );
+          if ( event->wd == watch_ && endsWith( name, suffix_ ) ) touched.insert( path( name ) );
+          const auto file = files_.find( { event->wd, name } );
+          if ( file != files_.end() ) touched.insert( file->second );
+        }
+        pos += sizeof(inotify_event)+event->len;
+      }
+
+      timeout = settleMs;
+    }
+
+    Changes changes;
+    for ( const auto& file : touched ) {
+      struct stat info;
+      if ( ::stat( file.c_str(), &info ) == 0 ) changes.modified.push_back( file );
+      else                                      changes.removed .push_back( file );
+    }
+    return changes;
+  }
+
+} // end of namespace util
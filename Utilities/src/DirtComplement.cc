@@ -0,0 +1,139 @@
+// Non-overlapping dirt volumes, per height slab.
+
+#include "Utilities/inc/DirtComplement.hh"
+#include "Utilities/inc/PolygonBoolean.hh"
+#include "Utilities/inc/SimpleConfigWriter.hh"
+#include "Utilities/inc/TextBuffer.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <utility>
+
+namespace {
+
+  const double minArea = 1.;   // mm^2
+
+  // Polygon of a volume in the frame of reference
+  util::Polygon footprint( const util::SimpleConfigVolume& volume, const util::SimpleConfigVolume& reference ) {
+    const double shiftX = volume.offsetFromMu2eOriginZ - reference.offsetFromMu2eOriginZ;
+    const double shiftY = volume.offsetFromMu2eOriginX - reference.offsetFromMu2eOriginX;
+    util::Polygon polygon;
+    for ( double x : volume.x ) polygon.x.push_back( x+shiftX );
+    for ( double y : volume.y ) polygon.y.push_back( y+shiftY );
+    return polygon;
+  }
+
+  double area( const util::Polygon& polygon ) {
+    const std::size_t n = polygon.x.size();
+    double sum(0);
+    for ( std::size_t i(0) ; i < n ; ++i ) sum += polygon.x[i]*polygon.y[(i+1)%n] - polygon.x[(i+1)%n]*polygon.y[i];
+    return 0.5*std::abs( sum );
+  }
+
+  struct Part {
+    util::Polygon polygon;
+    double        yMin;
+    double        yMax;
+    std::size_t   slab;
+    std::size_t   index;
+  };
+
+}
+
+namespace util {
+
+  //=========================================================================
+  std::vector<SimpleConfigVolume> dirtComplement( std::span<const SimpleConfigVolume> buildings,
+                                                  std::span<const SimpleConfigVolume> dirt,
+                                                  double worldX, double worldY ) {
+
+    if ( dirt.empty() ) return {};
+    const SimpleConfigVolume& reference = dirt.front();
+
+    std::vector<double> heights;
+    for ( const auto& volume : buildings ) { heights.push_back( volume.yMin ); heights.push_back( volume.yMax ); }
+    for ( const auto& volume : dirt      ) { heights.push_back( volume.yMin ); heights.push_back( volume.yMax ); }
+    std::sort( heights.begin(), heights.end() );
+    heights.erase( std::unique( heights.begin(), heights.end() ), heights.end() );
+
+    // Parts of the slab below stay open while the next slab has the
+    // same polygon
+    std::vector<Part> parts, open, next;
+    std::vector<Polygon> covered, removed;
+    for ( std::size_t k(0) ; k+1 < heights.size() ; ++k ) {
+      const double lo = heights[k], hi = heights[k+1];
+
+      covered.clear();
+      removed.clear();
+      for ( const auto& volume : dirt ) {
+        if ( volume.yMin <= lo && volume.yMax >= hi ) covered.push_back( footprint( volume, reference ) );
+      }
+      for ( const auto& volume : buildings ) {
+        if ( volume.yMin <= lo && volume.yMax >= hi ) removed.push_back( footprint( volume, reference ) );
+      }
+
+      std::vector<Polygon> pieces;
+      if ( !covered.empty() ) pieces = polygonDifference( covered, removed );
+
+      next.clear();
+      std::size_t index(0);
+      for ( auto& piece : pieces ) {
+        if ( area( piece ) <= minArea ) continue;
+        auto same = std::find_if( open.begin(), open.end(), [&]( const Part& part ){
+            return part.polygon.x == piece.x && part.polygon.y == piece.y; } );
+        if ( same != open.end() ) {
+          same->yMax = hi;
+          next.push_back( std::move( *same ) );
+          open.erase( same );
+        }
+        else next.push_back( { std::move( piece ), lo, hi, k, index++ } );
+      }
+      std::move( open.begin(), open.end(), std::back_inserter( parts ) );
+      std::swap( open, next );
+    }
+    std::move( open.begin(), open.end(), std::back_inserter( parts ) );
+
+    std::sort( parts.begin(), parts.end(), []( const Part& a, const Part& b ){
+        return a.slab != b.slab ? a.slab < b.slab : a.index < b.index; } );
+
+    std::vector<SimpleConfigVolume> volumes;
+    for ( auto& part : parts ) {
+      SimpleConfigVolume volume;
+      const std::string slab = std::to_string( part.slab ), index = std::to_string( part.index );
+      volume.name     = "dirtComplementSlab"+slab+"Part"+index;
+      volume.prefix   = "dirt.complement.slab"+slab+".part"+index;
+      volume.material = reference.material;
+
+      volume.yMin = part.yMin;
+      volume.yMax = part.yMax;
+
+      volume.yHalfThickness          = 0.5*(part.yMax-part.yMin);
+      volume.offsetFromMu2eOriginX   = reference.offsetFromMu2eOriginX;
+      volume.offsetFromFloorSurfaceY = part.yMin + volume.yHalfThickness;
+      volume.offsetFromMu2eOriginZ   = reference.offsetFromMu2eOriginZ;
+
+      volume.x = std::move( part.polygon.x );
+      volume.y = std::move( part.polygon.y );
+      setWorldReplace( volume, worldX, worldY );
+      volumes.push_back( std::move( volume ) );
+    }
+    return volumes;
+  }
+
+  //=========================================================================
+  std::string dirtComplementComment( const SimpleConfigVolume& volume ) {
+    TextBuffer comment;
+    comment << "// SimpleConfig geometry file automatically produced as part of the dirt\n";
+    comment << "// complement (dirt volumes minus buildings) from " << volume.yMin << " to " << volume.yMax << '\n';
+    return std::string( comment.view() );
+  }
+
+  //=========================================================================
+  void printDirtComplement( std::span<const SimpleConfigVolume> volumes, Config& config, const std::string& dir ) {
+    for ( const auto& volume : volumes ) printSimpleConfigFile( volume, dirtComplementComment( volume ), config, dir );
+  }
+
+} // end of namespace util
@@ -0,0 +1,117 @@
+// Writing of the C++ header of all volumes.
+
+#include "Utilities/inc/EmbeddedGeometryWriter.hh"
+#include "Utilities/inc/OutputFile.hh"
+#include "Utilities/inc/TextBuffer.hh"
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+  // A double literal: the shortest round-trip digits, with a '.' added
+  // to integral values so that they stay doubles
+  void appendDouble( util::TextBuffer& out, double value ) {
+    if ( !( value > -std::numeric_limits<double>::infinity() && value < std::numeric_limits<double>::infinity() ) )
+      throw std::runtime_error( "Non-finite number cannot be embedded in a header" );
+    char digits[32];
+    const auto result = std::to_chars( digits, digits+sizeof(digits), value );
+    const std::string_view text( digits, result.ptr-digits );
+    out << text;
+    if ( text.find_first_of( ".e" ) == std::string_view::npos ) out << '.';
+  }
+
+  void appendString( util::TextBuffer& out, const std::string& value ) {
+    out << '"';
+    for ( const char c : value ) {
+      if ( c == '"' || c == '\\' ) out << '\\';
+      out << c;
+    }
+    out << '"';
+  }
+
+  // Values written 8 to a line
+  template <typename T, typename Append>
+  void appendArray( util::TextBuffer& out, const std::vector<T>& values, Append append ) {
+    out << "      {";
+    for ( std::size_t i(0) ; i < values.size() ; ++i ) {
+      if ( i%8 == 0 ) out << "\n        ";
+      append( values[i] );
+      if ( i != values.size()-1 ) out << ", ";
+    }
+    out << "\n      }";
+  }
+
+}
+
+namespace util {
+
+  //=========================================================================
+  bool writeEmbeddedGeometry( const std::string& filename, const std::string& nameSpace, std::vector<SimpleConfigVolume> volumes ) {
+
+    std::sort( volumes.begin(), volumes.end(),
+               []( const SimpleConfigVolume& a, const SimpleConfigVolume& b ){ return a.prefix < b.prefix; } );
+
+    std::vector<double>        x, y;
+    std::vector<std::uint32_t> xReplace, yReplace;
+    for ( const auto& v : volumes ) {
+      if ( v.y.size() != v.x.size() ) throw std::runtime_error( "Vertex arrays of different lengths in volume "+v.prefix );
+      x.insert( x.end(), v.x.begin(), v.x.end() );
+      y.insert( y.end(), v.y.begin(), v.y.end() );
+      xReplace.insert( xReplace.end(), v.xReplace.begin(), v.xReplace.end() );
+      yReplace.insert( yReplace.end(), v.yReplace.begin(), v.yReplace.end() );
+    }
+
+    TextBuffer out;
+    out << "// Automatically produced by ProduceSimpleConfig; see Utilities/inc/EmbeddedGeometry.hh\n";
+    out << "#ifndef " << nameSpace << "_EmbeddedGeometry_hh\n";
+    out << "#define " << nameSpace << "_EmbeddedGeometry_hh\n\n";
+    out << "#include \"Utilities/inc/EmbeddedGeometry.hh\"\n\n";
+    out << "namespace " << nameSpace << " {\n\n";
+    out << "  inline constexpr util::EmbeddedGeometry<" << volumes.size() << ',' << x.size() << ','
+        << xReplace.size() << ',' << yReplace.size() << "> geometry = {\n";
+
+    // name, prefix, material, yMin, yMax, offsets, yHalfThickness, then
+    // the first index and count of the vertices, x and y replace indices
+    out << "    {{\n";
+    std::size_t vertex(0), xr(0), yr(0);
+    for ( const auto& v : volumes ) {
+      out << "      { ";
+      appendString( out, v.name     ); out << ", ";
+      appendString( out, v.prefix   ); out << ", ";
+      appendString( out, v.material ); out << ", ";
+      for ( const double value : { v.yMin, v.yMax, v.offsetFromMu2eOriginX, v.offsetFromFloorSurfaceY,
+                                   v.offsetFromMu2eOriginZ, v.yHalfThickness } ) {
+        appendDouble( out, value );
+        out << ", ";
+      }
+      out << vertex << ", " << v.x.size() << ", "
+          << xr     << ", " << v.xReplace.size() << ", "
+          << yr     << ", " << v.yReplace.size() << " },\n";
+      vertex += v.x.size();
+      xr     += v.xReplace.size();
+      yr     += v.yReplace.size();
+    }
+    out << "    }},\n";
+
+    auto appendIndex = [&]( std::uint32_t index ){ out << std::size_t( index ); };
+    out << "    // x\n";
+    appendArray( out, x, [&]( double value ){ appendDouble( out, value ); } ); out << ",\n";
+    out << "    // y\n";
+    appendArray( out, y, [&]( double value ){ appendDouble( out, value ); } ); out << ",\n";
+    out << "    // xReplace\n";
+    appendArray( out, xReplace, appendIndex ); out << ",\n";
+    out << "    // yReplace\n";
+    appendArray( out, yReplace, appendIndex ); out << '\n';
+    out << "  };\n\n";
+
+    out << "  static_assert( geometry.consistent(), \"inconsistent embedded geometry\" );\n\n";
+    out << "} // end of namespace " << nameSpace << "\n\n";
+    out << "#endif /* " << nameSpace << "_EmbeddedGeometry_hh */\n";
+
+    return writeIfChanged( filename, out.view() );
+  }
+
+} // end of namespace util
@@ -0,0 +1,46 @@
+// Loading of the ROOT drawing plugin.
+
+#include "Utilities/inc/GeometryDrawer.hh"
+
+#include <dlfcn.h>
+#include <limits.h>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+  const char* const pluginName = "libGeometryDrawer.so";
+
+  // <directory of the executable>/../lib/libGeometryDrawer.so
+  std::string besideExecutable() {
+    char path[PATH_MAX];
+    const ssize_t length = ::readlink( "/proc/self/exe", path, sizeof(path)-1 );
+    if ( length <= 0 ) return {};
+    const std::string executable( path, length );
+    const std::size_t slash = executable.rfind( '/' );
+    if ( slash == std::string::npos ) return {};
+    return executable.substr( 0, slash )+"/../lib/"+pluginName;
+  }
+
+}
+
+namespace util {
+
+  //=========================================================================
+  std::unique_ptr<GeometryDrawer> loadGeometryDrawer( int& argc, char** argv, double dx, double dy, double dz ) {
+
+    // The plugin stays loaded until the program exits: ROOT registers
+    // atexit handlers in it
+    void* handle = nullptr;
+    const std::string local = besideExecutable();
+    if ( !local.empty() ) handle = ::dlopen( local.c_str(), RTLD_NOW | RTLD_GLOBAL );
+    if ( handle == nullptr ) handle = ::dlopen( pluginName, RTLD_NOW | RTLD_GLOBAL );
+    if ( handle == nullptr ) throw std::runtime_error( std::string("Cannot load the drawing plugin: ")+::dlerror() );
+
+    auto create = reinterpret_cast<CreateGeometryDrawer*>( ::dlsym( handle, "createGeometryDrawer" ) );
+    if ( create == nullptr ) throw std::runtime_error( std::string("Drawing plugin without createGeometryDrawer: ")+::dlerror() );
+
+    return std::unique_ptr<GeometryDrawer>( create( &argc, argv, dx, dy, dz ) );
+  }
+
+} // end of namespace util
@@ -0,0 +1,105 @@
+// Bookkeeping for incremental regeneration of SimpleConfig files.
+
+#include "Utilities/inc/Manifest.hh"
+#include "Utilities/inc/OutputFile.hh"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+
+namespace {
+
+  bool fileExists( const std::string& filename ) {
+    struct stat info;
+    return ::stat( filename.c_str(), &info ) == 0;
+  }
+
+  void writeList( std::ostringstream& os, const std::string& key, const std::vector<std::string>& list ) {
+    for ( const auto& item : list ) os << key << '\t' << item << '\n';
+  }
+
+}
+
+namespace util {
+
+  //=========================================================================
+  std::uint64_t hashBytes( std::string_view data, std::uint64_t seed ) {
+    std::uint64_t hash = seed;
+    for ( const unsigned char c : data ) {
+      hash ^= c;
+      hash *= 0x100000001b3ULL;
+    }
+    return hash;
+  }
+
+  //=========================================================================
+  Manifest::Manifest( const std::string& filename )
+    : filename_( filename )
+  {
+    std::ifstream in( filename_ );
+    if ( !in.is_open() ) return;
+
+    Entry* current = nullptr;
+    std::string line;
+    while ( std::getline( in, line ) ) {
+      const std::size_t tab = line.find('\t');
+      if ( tab == std::string::npos ) continue;
+
+      const std::string key   = line.substr( 0, tab );
+      const std::string value = line.substr( tab+1 );
+
+      if ( key == "input" ) {
+        const std::size_t tab2 = value.find('\t');
+        if ( tab2 == std::string::npos ) { current = nullptr; continue; }
+        current = &entries_[ value.substr( tab2+1 ) ];
+        current->hash = std::stoull( value.substr( 0, tab2 ), nullptr, 16 );
+        continue;
+      }
+
+      // Ignore anything that does not follow an input line
+      if ( current == nullptr ) continue;
+
+      if      ( key == "bldgFile"   ) current->config.bldgFiles   .push_back( value );
+      else if ( key == "dirtFile"   ) current->config.dirtFiles   .push_back( value );
+      else if ( key == "bldgPrefix" ) current->config.bldgPrefixes.push_back( value );
+      else if ( key == "dirtPrefix" ) current->config.dirtPrefixes.push_back( value );
+      else if ( key == "output"     ) current->config.outputFiles .push_back( value );
+      else if ( key == "problem"    ) current->problems           .push_back( value );
+    }
+  }
+
+  //=========================================================================
+  const Manifest::Entry* Manifest::find( const std::string& inputFile, std::uint64_t hash ) const {
+
+    auto match = entries_.find( inputFile );
+    if ( match == entries_.end() || match->second.hash != hash ) return nullptr;
+
+    for ( const auto& output : match->second.config.outputFiles ) {
+      if ( !fileExists( output ) ) return nullptr;
+    }
+
+    return &match->second;
+  }
+
+  //=========================================================================
+  bool Manifest::write() const {
+
+    std::ostringstream os;
+    for ( const auto& entry : entries_ ) {
+      const Config& config = entry.second.config;
+      os << "input\t" << std::hex << std::setw(16) << std::setfill('0') << entry.second.hash << std::dec
+         << '\t' << entry.first << '\n';
+      writeList( os, "bldgFile"  , config.bldgFiles    );
+      writeList( os, "dirtFile"  , config.dirtFiles    );
+      writeList( os, "bldgPrefix", config.bldgPrefixes );
+      writeList( os, "dirtPrefix", config.dirtPrefixes );
+      writeList( os, "output"    , config.outputFiles  );
+      writeList( os, "problem"   , entry.second.problems );
+    }
+
+    return writeIfChanged( filename_, os.str() );
+  }
+
+} // end of namespace util
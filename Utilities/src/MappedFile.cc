@@ -0,0 +1,84 @@
+// Read-only memory mapping of a whole file.
+
+#include "Utilities/inc/MappedFile.hh"
+#include "Utilities/inc/Profiler.hh"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace util {
+
+  //=========================================================================
+  MappedFile::MappedFile( const std::string& filename )
+    : filename_( filename )
+    , data_( nullptr )
+    , size_( 0 )
+  {
+    const int fd = ::open( filename_.c_str(), O_RDONLY );
+    if ( fd < 0 )
+      throw std::runtime_error("Cannot open file: "+filename_+" ("+std::strerror(errno)+")");
+
+    struct stat info;
+    if ( ::fstat( fd, &info ) != 0 ) {
+      const int error = errno;
+      ::close( fd );
+      throw std::runtime_error("Cannot stat file: "+filename_+" ("+std::strerror(error)+")");
+    }
+
+    // An empty file cannot be mapped; leave the view empty
+    size_ = info.st_size;
+    if ( size_ != 0 ) {
+      void* addr = ::mmap( nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0 );
+      if ( addr == MAP_FAILED ) {
+        const int error = errno;
+        ::close( fd );
+        throw std::runtime_error("Cannot map file: "+filename_+" ("+std::strerror(error)+")");
+      }
+      ::madvise( addr, size_, MADV_SEQUENTIAL );
+      data_ = static_cast<const char*>( addr );
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    ::close( fd );
+
+    UTIL_PROFILE_BYTES_READ( size_ );
+  }
+
+  //=========================================================================
+  MappedFile::~MappedFile() {
+    unmap();
+  }
+
+  //=========================================================================
+  MappedFile::MappedFile( MappedFile&& other ) noexcept
+    : filename_( std::move( other.filename_ ) )
+    , data_( std::exchange( other.data_, nullptr ) )
+    , size_( std::exchange( other.size_, 0 ) )
+  {}
+
+  //=========================================================================
+  MappedFile& MappedFile::operator=( MappedFile&& other ) noexcept {
+    if ( this != &other ) {
+      unmap();
+      filename_ = std::move( other.filename_ );
+      data_     = std::exchange( other.data_, nullptr );
+      size_     = std::exchange( other.size_, 0 );
+    }
+    return *this;
+  }
+
+  //=========================================================================
+  void MappedFile::unmap() {
+    if ( data_ != nullptr ) ::munmap( const_cast<char*>( data_ ), size_ );
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+} // end of namespace util
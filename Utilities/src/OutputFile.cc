@@ -0,0 +1,86 @@
+// Atomic and change-only writing of generated files.
+
+#include "Utilities/inc/OutputFile.hh"
+#include "Utilities/inc/MappedFile.hh"
+#include "Utilities/inc/Profiler.hh"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+  [[noreturn]] void writeError( const std::string& what, const std::string& filename, int error ) {
+    throw std::runtime_error( what+filename+" ("+std::strerror(error)+")" );
+  }
+
+  // Distinguishes the temporary files of concurrent writers: the pid
+  // separates processes, the counter the threads of one process
+  std::string temporaryName( const std::string& filename ) {
+    static std::atomic<unsigned> counter(0);
+    return filename+".tmp."+std::to_string( ::getpid() )+"."+std::to_string( counter++ );
+  }
+
+}
+
+namespace util {
+
+  //=========================================================================
+  void writeAtomically( const std::string& filename, std::string_view contents ) {
+
+    const std::string tmpname = temporaryName( filename );
+
+    const int fd = ::open( tmpname.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666 );
+    if ( fd < 0 ) writeError( "Cannot write file: ", tmpname, errno );
+
+    // One write() normally suffices; loop in case the kernel accepts less
+    const char* data = contents.data();
+    std::size_t left = contents.size();
+    while ( left > 0 ) {
+      const ssize_t written = ::write( fd, data, left );
+      if ( written < 0 && errno == EINTR ) continue;
+      if ( written < 0 ) {
+        const int error = errno;
+        ::close( fd );
+        ::unlink( tmpname.c_str() );
+        writeError( "Cannot write file: ", tmpname, error );
+      }
+      data += written;
+      left -= written;
+    }
+
+    if ( ::close( fd ) != 0 ) {
+      const int error = errno;
+      ::unlink( tmpname.c_str() );
+      writeError( "Cannot write file: ", tmpname, error );
+    }
+
+    if ( ::rename( tmpname.c_str(), filename.c_str() ) != 0 ) {
+      const int error = errno;
+      ::unlink( tmpname.c_str() );
+      writeError( "Cannot rename temporary file to: ", filename, error );
+    }
+
+    UTIL_PROFILE_BYTES_WRITTEN( contents.size() );
+  }
+
+  //=========================================================================
+  bool writeIfChanged( const std::string& filename, std::string_view contents ) {
+
+    // Only files of the right size need to be compared
+    struct stat info;
+    if ( ::stat( filename.c_str(), &info ) == 0 &&
+         static_cast<std::size_t>( info.st_size ) == contents.size() ) {
+      if ( MappedFile( filename ).contents() == contents ) return false;
+    }
+
+    writeAtomically( filename, contents );
+    return true;
+  }
+
+} // end of namespace util
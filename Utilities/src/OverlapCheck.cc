@@ -0,0 +1,176 @@
+// Overlaps between the extruded volumes of the hall.
+
+#include "Utilities/inc/OverlapCheck.hh"
+#include "Utilities/inc/BoundingVolumeHierarchy.hh"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+
+  struct Point {
+    double x;
+    double y;
+  };
+
+  double cross( const Point& o, const Point& a, const Point& b ) {
+    return (a.x-o.x)*(b.y-o.y) - (a.y-o.y)*(b.x-o.x);
+  }
+
+  // Counter-clockwise triangle with its bounding box
+  struct Triangle {
+    std::array<Point,3> p;
+    double xMin, xMax, yMin, yMax;
+  };
+
+  // The fan of a polygon about the origin: one counter-clockwise
+  // triangle per edge, with the sign of the edge's contribution to the
+  // winding number
+  void makeFan( std::span<const double> x, std::span<const double> y, const Point& origin,
+                std::vector<Triangle>& triangles, std::vector<double>& signs ) {
+    const std::size_t n = std::min( x.size(), y.size() );
+    triangles.clear();
+    signs.clear();
+    for ( std::size_t i(0) ; i < n ; ++i ) {
+      const Point a{ x[i], y[i] };
+      const Point b{ x[(i+1)%n], y[(i+1)%n] };
+      const double c = cross( origin, a, b );
+      if ( c == 0 ) continue;
+
+      Triangle t;
+      t.p = ( c > 0 ) ? std::array<Point,3>{ origin, a, b } : std::array<Point,3>{ origin, b, a };
+      t.xMin = std::min( { origin.x, a.x, b.x } );
+      t.xMax = std::max( { origin.x, a.x, b.x } );
+      t.yMin = std::min( { origin.y, a.y, b.y } );
+      t.yMax = std::max( { origin.y, a.y, b.y } );
+      triangles.push_back( t );
+      signs.push_back( c > 0 ? 1. : -1. );
+    }
+  }
+
+  // Area of the intersection of two counter-clockwise triangles:
+  // Sutherland-Hodgman clipping of the first by the edges of the second
+  double clippedArea( const Triangle& subject, const Triangle& clip ) {
+
+    // A triangle clipped by three half-planes has at most six vertices
+    std::array<Point,9> polygon, next;
+    std::size_t n(3), m(0);
+    std::copy( subject.p.begin(), subject.p.end(), polygon.begin() );
+
+    for ( std::size_t e(0) ; e < 3 && n > 0 ; ++e ) {
+      const Point& a = clip.p[e];
+      const Point& b = clip.p[(e+1)%3];
+      m = 0;
+      for ( std::size_t i(0) ; i < n ; ++i ) {
+        const Point& p = polygon[i];
+        const Point& q = polygon[(i+1)%n];
+        const double sp = cross( a, b, p );
+        const double sq = cross( a, b, q );
+        if ( sp >= 0 ) next[m++] = p;
+        if ( ( sp > 0 && sq < 0 ) || ( sp < 0 && sq > 0 ) ) {
+          const double t = sp/(sp-sq);
+          next[m++] = { p.x+t*(q.x-p.x), p.y+t*(q.y-p.y) };
+        }
+      }
+      std::swap( polygon, next );
+      n = m;
+    }
+
+    double twiceArea(0.);
+    for ( std::size_t i(0) ; i < n ; ++i ) {
+      const Point& p = polygon[i];
+      const Point& q = polygon[(i+1)%n];
+      twiceArea += p.x*q.y - q.x*p.y;
+    }
+    return 0.5*twiceArea;
+  }
+
+  double signedArea( std::span<const double> x, std::span<const double> y ) {
+    const std::size_t n = std::min( x.size(), y.size() );
+    double twiceArea(0.);
+    for ( std::size_t i(0) ; i < n ; ++i ) twiceArea += x[i]*y[(i+1)%n] - x[(i+1)%n]*y[i];
+    return 0.5*twiceArea;
+  }
+
+  util::BoundingVolumeHierarchy::Box footprintBox( std::span<const double> x, std::span<const double> y,
+                                                   double yMin = 0., double yMax = 0. ) {
+    util::BoundingVolumeHierarchy::Box box;
+    box.min = { *std::min_element( x.begin(), x.end() ), *std::min_element( y.begin(), y.end() ), yMin };
+    box.max = { *std::max_element( x.begin(), x.end() ), *std::max_element( y.begin(), y.end() ), yMax };
+    return box;
+  }
+
+}
+
+namespace util {
+
+  //=========================================================================
+  double intersectionArea( std::span<const double> x1, std::span<const double> y1,
+                           std::span<const double> x2, std::span<const double> y2 ) {
+
+    if ( x1.size() < 3 || x2.size() < 3 ) return 0.;
+
+    const double orientation = ( signedArea( x1, y1 ) < 0 ? -1. : 1. )*( signedArea( x2, y2 ) < 0 ? -1. : 1. );
+
+    // Fans about the centre of the overlap of the bounding boxes, which
+    // keeps the triangles, and the cancellations between them, small
+    const BoundingVolumeHierarchy::Box b1 = footprintBox( x1, y1 );
+    const BoundingVolumeHierarchy::Box b2 = footprintBox( x2, y2 );
+    const Point origin{ 0.5*( std::max( b1.min[0], b2.min[0] ) + std::min( b1.max[0], b2.max[0] ) ),
+                        0.5*( std::max( b1.min[1], b2.min[1] ) + std::min( b1.max[1], b2.max[1] ) ) };
+
+    thread_local std::vector<Triangle> fan1, fan2;
+    thread_local std::vector<double>   signs1, signs2;
+    makeFan( x1, y1, origin, fan1, signs1 );
+    makeFan( x2, y2, origin, fan2, signs2 );
+
+    double area(0.);
+    for ( std::size_t i(0) ; i < fan1.size() ; ++i ) {
+      const Triangle& t1 = fan1[i];
+      for ( std::size_t j(0) ; j < fan2.size() ; ++j ) {
+        const Triangle& t2 = fan2[j];
+        if ( t1.xMax <= t2.xMin || t2.xMax <= t1.xMin || t1.yMax <= t2.yMin || t2.yMax <= t1.yMin ) continue;
+        area += signs1[i]*signs2[j]*clippedArea( t1, t2 );
+      }
+    }
+
+    return orientation*area;
+  }
+
+  //=========================================================================
+  std::vector<VolumeOverlap> findOverlaps( std::span<const SimpleConfigVolume> volumes, double minArea ) {
+
+    std::vector<BoundingVolumeHierarchy::Box> boxes;
+    std::vector<std::size_t>                  index;
+    for ( std::size_t i(0) ; i < volumes.size() ; ++i ) {
+      const SimpleConfigVolume& v = volumes[i];
+      if ( v.x.size() < 3 || v.x.size() != v.y.size() ) continue;
+      boxes.push_back( footprintBox( v.x, v.y, v.yMin, v.yMax ) );
+      index.push_back( i );
+    }
+
+    const BoundingVolumeHierarchy bvh( std::move( boxes ) );
+
+    std::vector<VolumeOverlap> overlaps;
+    bvh.overlappingPairs( [&]( std::size_t k, std::size_t l ){
+        const SimpleConfigVolume& a = volumes[ index[k] ];
+        const SimpleConfigVolume& b = volumes[ index[l] ];
+
+        const double height = std::min( a.yMax, b.yMax ) - std::max( a.yMin, b.yMin );
+        if ( height <= 0 ) return;
+
+        const double area = intersectionArea( a.x, a.y, b.x, b.y );
+        if ( area <= minArea ) return;
+
+        overlaps.push_back( { index[k], index[l], area, height, area*height } );
+      } );
+
+    std::sort( overlaps.begin(), overlaps.end(), []( const VolumeOverlap& a, const VolumeOverlap& b ){
+        return a.first < b.first || ( a.first == b.first && a.second < b.second );
+      } );
+
+    return overlaps;
+  }
+
+} // end of namespace util
@@ -0,0 +1,377 @@
+// Difference of sets of polygons by vertical strip decomposition.
+
+#include "Utilities/inc/PolygonBoolean.hh"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <set>
+#include <utility>
+
+namespace {
+
+  // Rounding to the grid of the tolerance
+  struct Grid {
+    double scale;
+    double operator()( double v ) const { return std::round( v*scale )/scale; }
+  };
+
+  typedef std::pair<double,double> Point;
+
+  // Polygon edge stored from its lower-x end, with the change of the
+  // winding number of its polygon when the edge is crossed upwards
+  struct Edge {
+    double      x0, y0, x1, y1;
+    std::size_t polygon;
+    int         winding;
+  };
+
+  // An edge within a strip: its y at the left and right boundaries
+  struct Crossing {
+    double      y0, y1;
+    std::size_t polygon;
+    int         winding;
+  };
+
+  // Part of the region in one strip: bottom and top at the left (0) and
+  // right (1) boundaries
+  struct Trapezoid {
+    std::size_t strip;
+    double      bottom0, bottom1;
+    double      top0, top1;
+  };
+
+  // A trapezoid touching another one along [lo,hi] of its left or
+  // right side (lo == hi for a single point)
+  struct Contact {
+    std::size_t other;
+    double      lo, hi;
+    int         side;   // 0 left, 1 right
+  };
+
+  //=========================================================================
+  void addEdges( const util::Polygon& polygon, std::size_t id, const Grid& snap, std::vector<Edge>& edges ) {
+
+    const std::size_t n = std::min( polygon.x.size(), polygon.y.size() );
+    std::vector<double> x( n ), y( n );
+    for ( std::size_t i(0) ; i < n ; ++i ) {
+      x[i] = snap( polygon.x[i] );
+      y[i] = snap( polygon.y[i] );
+    }
+
+    for ( std::size_t i(0) ; i < n ; ++i ) {
+      const std::size_t j = (i+1)%n;
+      if      ( x[i] < x[j] ) edges.push_back( { x[i], y[i], x[j], y[j], id,  1 } );
+      else if ( x[i] > x[j] ) edges.push_back( { x[j], y[j], x[i], y[i], id, -1 } );
+    }
+  }
+
+  //=========================================================================
+  double yAt( const Edge& e, double x ) {
+    if ( x <= e.x0 ) return e.y0;
+    if ( x >= e.x1 ) return e.y1;
+    return e.y0 + (e.y1-e.y0)*( (x-e.x0)/(e.x1-e.x0) );
+  }
+
+  //=========================================================================
+  // x of the crossings of the edges (sorted by x0), other than at end points
+  void addCrossings( const std::vector<Edge>& edges, const Grid& snap, std::vector<double>& xs ) {
+    for ( std::size_t i(0) ; i < edges.size() ; ++i ) {
+      const Edge& e = edges[i];
+      for ( std::size_t j(i+1) ; j < edges.size() && edges[j].x0 < e.x1 ; ++j ) {
+        const Edge& f = edges[j];
+        const double rx = e.x1-e.x0, ry = e.y1-e.y0;
+        const double sx = f.x1-f.x0, sy = f.y1-f.y0;
+        const double denom = rx*sy - ry*sx;
+        if ( denom == 0 ) continue;
+        const double qx = f.x0-e.x0, qy = f.y0-e.y0;
+        const double t = ( qx*sy - qy*sx )/denom;
+        const double u = ( qx*ry - qy*rx )/denom;
+        if ( t > 0 && t < 1 && u > 0 && u < 1 ) xs.push_back( snap( e.x0 + t*rx ) );
+      }
+    }
+  }
+
+  //=========================================================================
+  // Whether adding trapezoid u to piece p keeps the piece a disk: the
+  // contact must be one connected set of positive length
+  bool touchesAlongOneSegment( const std::vector<Contact>& contacts, const std::vector<int>& piece, int p ) {
+    std::array<std::vector<std::pair<double,double>>,2> sides;
+    for ( const auto& c : contacts ) {
+      if ( piece[c.other] == p ) sides[c.side].emplace_back( c.lo, c.hi );
+    }
+
+    int  components(0);
+    bool segment(false);
+    for ( auto& intervals : sides ) {
+      if ( intervals.empty() ) continue;
+      std::sort( intervals.begin(), intervals.end() );
+      std::pair<double,double> current = intervals.front();
+      for ( std::size_t i(1) ; i < intervals.size() ; ++i ) {
+        if ( intervals[i].first <= current.second ) {
+          current.second = std::max( current.second, intervals[i].second );
+          continue;
+        }
+        ++components;
+        segment |= current.second > current.first;
+        current = intervals[i];
+      }
+      ++components;
+      segment |= current.second > current.first;
+    }
+    return components == 1 && segment;
+  }
+
+  //=========================================================================
+  // Drops vertices within tolerance of the segment joining their neighbours
+  void removeCollinear( std::vector<Point>& ring, double tolerance ) {
+    bool changed = true;
+    while ( changed ) {
+      changed = false;
+      for ( std::size_t i(0) ; i < ring.size() && ring.size() > 3 ; ) {
+        const std::size_t n = ring.size();
+        const Point& a = ring[(i+n-1)%n];
+        const Point& b = ring[i];
+        const Point& c = ring[(i+1)%n];
+        const double dx = c.first-a.first, dy = c.second-a.second;
+        const double length = std::hypot( dx, dy );
+        const bool between = (b.first-a.first)*dx + (b.second-a.second)*dy >= 0 &&
+                             (c.first-b.first)*dx + (c.second-b.second)*dy >= 0;
+        if ( length == 0 ||
+             ( between && std::abs( dx*(b.second-a.second) - dy*(b.first-a.first) ) <= tolerance*length ) ) {
+          ring.erase( ring.begin()+i );
+          changed = true;
+        }
+        else ++i;
+      }
+    }
+  }
+
+  //=========================================================================
+  util::Polygon toPolygon( const std::vector<Point>& ring ) {
+    util::Polygon polygon;
+    for ( const auto& p : ring ) {
+      polygon.x.push_back( p.first );
+      polygon.y.push_back( p.second );
+    }
+    return polygon;
+  }
+
+  //=========================================================================
+  // The boundary of the union of the trapezoids of a piece as one ring,
+  // or an empty ring if the union is not bounded by a single cycle
+  std::vector<Point> traceBoundary( const std::vector<std::size_t>& members,
+                                    const std::vector<Trapezoid>& traps,
+                                    const std::vector<std::vector<Contact>>& contacts,
+                                    const std::vector<int>& piece,
+                                    const std::vector<double>& xs ) {
+
+    // Directed boundary segments (counter-clockwise); a segment shared
+    // by two trapezoids appears once in each direction and cancels
+    std::set<std::array<double,4>> segments;
+    auto add = [&]( const Point& a, const Point& b ) {
+      if ( a == b ) return;
+      auto reverse = segments.find( { b.first, b.second, a.first, a.second } );
+      if ( reverse != segments.end() ) segments.erase( reverse );
+      else segments.insert( { a.first, a.second, b.first, b.second } );
+    };
+
+    for ( std::size_t t : members ) {
+      const Trapezoid& T = traps[t];
+      const double xa = xs[T.strip], xb = xs[T.strip+1];
+
+      // Sides are split where the contacts with the piece begin and end
+      std::array<std::vector<double>,2> cuts{ std::vector<double>{ T.bottom0, T.top0 },
+                                              std::vector<double>{ T.bottom1, T.top1 } };
+      for ( const auto& c : contacts[t] ) {
+        if ( piece[c.other] != piece[t] ) continue;
+        cuts[c.side].push_back( c.lo );
+        cuts[c.side].push_back( c.hi );
+      }
+      for ( auto& side : cuts ) {
+        std::sort( side.begin(), side.end() );
+        side.erase( std::unique( side.begin(), side.end() ), side.end() );
+      }
+
+      add( { xa, T.bottom0 }, { xb, T.bottom1 } );
+      for ( std::size_t i(1) ; i < cuts[1].size() ; ++i ) add( { xb, cuts[1][i-1] }, { xb, cuts[1][i] } );
+      add( { xb, T.top1 }, { xa, T.top0 } );
+      for ( std::size_t i(cuts[0].size()-1) ; i > 0 ; --i ) add( { xa, cuts[0][i] }, { xa, cuts[0][i-1] } );
+    }
+
+    std::map<Point,Point> next;
+    for ( const auto& s : segments ) {
+      if ( !next.emplace( Point{ s[0], s[1] }, Point{ s[2], s[3] } ).second ) return {};
+    }
+    if ( next.empty() ) return {};
+
+    std::vector<Point> ring;
+    Point p = next.begin()->first;
+    do {
+      ring.push_back( p );
+      auto it = next.find( p );
+      if ( it == next.end() || ring.size() > next.size() ) return {};
+      p = it->second;
+    } while ( p != ring.front() );
+
+    if ( ring.size() != next.size() ) return {};
+    return ring;
+  }
+
+}
+
+namespace util {
+
+  //=========================================================================
+  std::vector<Polygon> polygonDifference( std::span<const Polygon> covered,
+                                          std::span<const Polygon> removed,
+                                          double tolerance ) {
+
+    const Grid snap{ 1./tolerance };
+
+    // Polygons [0,covered.size()) are covered, the others removed
+    std::vector<Edge> edges;
+    for ( std::size_t i(0) ; i < covered.size() ; ++i ) addEdges( covered[i], i, snap, edges );
+    for ( std::size_t i(0) ; i < removed.size() ; ++i ) addEdges( removed[i], covered.size()+i, snap, edges );
+    std::sort( edges.begin(), edges.end(), []( const Edge& a, const Edge& b ){ return a.x0 < b.x0; } );
+
+    // Strip boundaries
+    std::vector<double> xs;
+    for ( const auto& e : edges ) {
+      xs.push_back( e.x0 );
+      xs.push_back( e.x1 );
+    }
+    addCrossings( edges, snap, xs );
+    std::sort( xs.begin(), xs.end() );
+    xs.erase( std::unique( xs.begin(), xs.end() ), xs.end() );
+    if ( xs.size() < 2 ) return {};
+
+    // Trapezoids, strip by strip from the left and bottom to top in a
+    // strip; those of strip s are [stripBegin[s],stripBegin[s+1])
+    const std::size_t nStrips = xs.size()-1;
+    std::vector<Trapezoid>   traps;
+    std::vector<std::size_t> stripBegin( nStrips+1 );
+    std::vector<std::size_t> active;
+    std::vector<Crossing>    crossings;
+    std::vector<int>         winding( covered.size()+removed.size() );
+    std::size_t nextEdge(0);
+
+    for ( std::size_t s(0) ; s < nStrips ; ++s ) {
+      stripBegin[s] = traps.size();
+      const double xa = xs[s], xb = xs[s+1];
+
+      active.erase( std::remove_if( active.begin(), active.end(), [&]( std::size_t e ){ return edges[e].x1 <= xa; } ),
+                    active.end() );
+      for ( ; nextEdge < edges.size() && edges[nextEdge].x0 <= xa ; ++nextEdge ) active.push_back( nextEdge );
+
+      crossings.clear();
+      for ( std::size_t e : active ) {
+        crossings.push_back( { snap( yAt( edges[e], xa ) ), snap( yAt( edges[e], xb ) ), edges[e].polygon, edges[e].winding } );
+      }
+      std::sort( crossings.begin(), crossings.end(), []( const Crossing& a, const Crossing& b ){
+          const double sa = a.y0+a.y1, sb = b.y0+b.y1;
+          if ( sa != sb ) return sa < sb;
+          return a.y0 != b.y0 ? a.y0 < b.y0 : a.y1 < b.y1;
+        } );
+
+      // Number of polygons of either set with a non-zero winding number
+      // between the edges; coincident edges are crossed together
+      std::array<int,2> inPolygons{ 0, 0 };
+      bool inside(false);
+      double bottom0(0), bottom1(0);
+      for ( std::size_t i(0) ; i < crossings.size() ; ) {
+        const double y0 = crossings[i].y0, y1 = crossings[i].y1;
+        for ( ; i < crossings.size() && crossings[i].y0 == y0 && crossings[i].y1 == y1 ; ++i ) {
+          int& w = winding[ crossings[i].polygon ];
+          const int before = w;
+          w += crossings[i].winding;
+          inPolygons[ crossings[i].polygon >= covered.size() ] += ( w != 0 ) - ( before != 0 );
+        }
+        const bool now = inPolygons[0] > 0 && inPolygons[1] == 0;
+        if ( now && !inside ) {
+          bottom0 = y0;
+          bottom1 = y1;
+        }
+        if ( inside && !now ) {
+          const Trapezoid T{ s, bottom0, bottom1, std::max( bottom0, y0 ), std::max( bottom1, y1 ) };
+          if ( T.top0 != T.bottom0 || T.top1 != T.bottom1 ) traps.push_back( T );
+        }
+        inside = now;
+      }
+    }
+    stripBegin[nStrips] = traps.size();
+
+    // Which trapezoids touch, across strip boundaries and at the corners
+    // of neighbours in a strip
+    std::vector<std::vector<Contact>> contacts( traps.size() );
+    for ( std::size_t s(0) ; s < nStrips ; ++s ) {
+      for ( std::size_t t(stripBegin[s]) ; t < stripBegin[s+1] ; ++t ) {
+        const Trapezoid& T = traps[t];
+        if ( t+1 < stripBegin[s+1] ) {
+          const Trapezoid& U = traps[t+1];
+          if ( T.top0 == U.bottom0 ) {
+            contacts[t]  .push_back( { t+1, T.top0, T.top0, 0 } );
+            contacts[t+1].push_back( { t  , T.top0, T.top0, 0 } );
+          }
+          if ( T.top1 == U.bottom1 ) {
+            contacts[t]  .push_back( { t+1, T.top1, T.top1, 1 } );
+            contacts[t+1].push_back( { t  , T.top1, T.top1, 1 } );
+          }
+        }
+        if ( s+1 == nStrips ) continue;
+        for ( std::size_t u(stripBegin[s+1]) ; u < stripBegin[s+2] ; ++u ) {
+          const Trapezoid& U = traps[u];
+          const double lo = std::max( T.bottom1, U.bottom0 );
+          const double hi = std::min( T.top1   , U.top0    );
+          if ( lo > hi ) continue;
+          contacts[t].push_back( { u, lo, hi, 1 } );
+          contacts[u].push_back( { t, lo, hi, 0 } );
+        }
+      }
+    }
+
+    // Grow the pieces breadth first from the leftmost free trapezoid; a
+    // rejected neighbour is looked at again whenever the piece grows
+    // next to it
+    std::vector<int> piece( traps.size(), -1 );
+    std::vector<std::vector<std::size_t>> members;
+    for ( std::size_t seed(0) ; seed < traps.size() ; ++seed ) {
+      if ( piece[seed] >= 0 ) continue;
+      const int p = members.size();
+      piece[seed] = p;
+      members.push_back( { seed } );
+      for ( std::size_t k(0) ; k < members[p].size() ; ++k ) {
+        for ( const auto& c : contacts[ members[p][k] ] ) {
+          if ( piece[c.other] >= 0 || !touchesAlongOneSegment( contacts[c.other], piece, p ) ) continue;
+          piece[c.other] = p;
+          members[p].push_back( c.other );
+        }
+      }
+    }
+
+    std::vector<Polygon> result;
+    for ( auto& m : members ) {
+      std::sort( m.begin(), m.end() );
+      std::vector<Point> ring = traceBoundary( m, traps, contacts, piece, xs );
+      if ( !ring.empty() ) {
+        removeCollinear( ring, tolerance );
+        result.push_back( toPolygon( ring ) );
+        continue;
+      }
+      // Not a disk after all (only possible through rounding): one
+      // polygon per trapezoid
+      for ( std::size_t t : m ) {
+        const Trapezoid& T = traps[t];
+        const double xa = xs[T.strip], xb = xs[T.strip+1];
+        std::vector<Point> quad{ { xa, T.bottom0 }, { xb, T.bottom1 } };
+        if ( T.top1 != T.bottom1 ) quad.push_back( { xb, T.top1 } );
+        if ( T.top0 != T.bottom0 ) quad.push_back( { xa, T.top0 } );
+        result.push_back( toPolygon( quad ) );
+      }
+    }
+    return result;
+  }
+
+} // end of namespace util
@@ -0,0 +1,273 @@
+// Validity check of extrusion polygons.
+
+#include "Utilities/inc/PolygonCheck.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <numeric>
+#include <set>
+
+namespace {
+
+  struct Point {
+    double x;
+    double y;
+  };
+
+  bool operator==( const Point& a, const Point& b ) { return a.x == b.x && a.y == b.y; }
+  bool operator< ( const Point& a, const Point& b ) { return a.x < b.x || ( a.x == b.x && a.y < b.y ); }
+
+  // > 0 if o-a-b turns counter-clockwise, < 0 if clockwise, 0 if collinear
+  double cross( const Point& o, const Point& a, const Point& b ) {
+    return (a.x-o.x)*(b.y-o.y) - (a.y-o.y)*(b.x-o.x);
+  }
+
+  int sign( double value ) { return ( value > 0 ) - ( value < 0 ); }
+
+  // r, collinear with p-q, lies within the segment
+  bool onSegment( const Point& p, const Point& q, const Point& r ) {
+    return std::min( p.x, q.x ) <= r.x && r.x <= std::max( p.x, q.x ) &&
+           std::min( p.y, q.y ) <= r.y && r.y <= std::max( p.y, q.y );
+  }
+
+  // Closed segments p1-q1 and p2-q2 share at least one point
+  bool segmentsIntersect( const Point& p1, const Point& q1, const Point& p2, const Point& q2 ) {
+    const int o1 = sign( cross( p1, q1, p2 ) );
+    const int o2 = sign( cross( p1, q1, q2 ) );
+    const int o3 = sign( cross( p2, q2, p1 ) );
+    const int o4 = sign( cross( p2, q2, q1 ) );
+
+    if ( o1 != o2 && o3 != o4 ) return true;
+
+    return ( o1 == 0 && onSegment( p1, q1, p2 ) ) ||
+           ( o2 == 0 && onSegment( p1, q1, q2 ) ) ||
+           ( o3 == 0 && onSegment( p2, q2, p1 ) ) ||
+           ( o4 == 0 && onSegment( p2, q2, q1 ) );
+  }
+
+  // An edge of the polygon with its endpoints in sweep order (left,
+  // then bottom, first)
+  struct Segment {
+    Point       left;
+    Point       right;
+    std::size_t edge;
+  };
+
+  double yAt( const Segment& s, double x ) {
+    if ( s.left.x == s.right.x ) return s.left.y;
+    return s.left.y + (s.right.y-s.left.y)*(x-s.left.x)/(s.right.x-s.left.x);
+  }
+
+  // Order of the segments crossing the sweep line, bottom to top.  Two
+  // segments are compared where both exist; segments through the same
+  // point there are ordered by direction.  This is a strict weak order
+  // as long as no two segments in the set intersect other than at
+  // shared endpoints, which holds until the sweep stops.
+  struct Below {
+    bool operator()( const Segment* a, const Segment* b ) const {
+      if ( a == b ) return false;
+      const double x  = std::max( a->left.x, b->left.x );
+      const double ya = yAt( *a, x );
+      const double yb = yAt( *b, x );
+      if ( ya != yb ) return ya < yb;
+      const double turn = (a->right.x-a->left.x)*(b->right.y-b->left.y) - (a->right.y-a->left.y)*(b->right.x-b->left.x);
+      if ( turn != 0 ) return turn > 0;
+      return a->edge < b->edge;
+    }
+  };
+
+  // The polygon without repeated consecutive vertices; origin holds the
+  // index of each vertex in the checked polygon
+  struct Ring {
+    std::vector<Point>       points;
+    std::vector<std::size_t> origin;
+
+    std::size_t   size()                  const { return points.size(); }
+    const Point&  vertex( std::size_t k ) const { return points[k]; }
+    const Point&  next  ( std::size_t k ) const { return points[ (k+1)%points.size() ]; }
+  };
+
+  // Edges k and l of the ring intersect other than at a vertex they share
+  bool edgesIntersect( const Ring& ring, std::size_t k, std::size_t l ) {
+    const std::size_t m = ring.size();
+
+    // Consecutive edges only touch improperly if they fold back
+    // onto each other
+    if ( (k+1)%m == l || (l+1)%m == k ) {
+      if ( (l+1)%m == k ) std::swap( k, l );
+      const Point& shared = ring.vertex( l );
+      const Point& a      = ring.vertex( k );
+      const Point& b      = ring.next  ( l );
+      return cross( a, shared, b ) == 0 &&
+             (a.x-shared.x)*(b.x-shared.x) + (a.y-shared.y)*(b.y-shared.y) > 0;
+    }
+
+    return segmentsIntersect( ring.vertex( k ), ring.next( k ), ring.vertex( l ), ring.next( l ) );
+  }
+
+  // Shamos-Hoey: returns true and sets (k,l) for the first intersecting
+  // pair of edges found
+  bool findIntersection( const Ring& ring, std::size_t& k, std::size_t& l ) {
+
+    const std::size_t m = ring.size();
+
+    std::vector<Segment> segments( m );
+    for ( std::size_t e(0) ; e < m ; ++e ) {
+      const Point& a = ring.vertex( e );
+      const Point& b = ring.next  ( e );
+      segments[e] = ( a < b ) ? Segment{ a, b, e } : Segment{ b, a, e };
+    }
+
+    // Events: 2e is the insertion of edge e, 2e+1 its removal.  At the
+    // same point insertions come first, so that edges touching there
+    // are in the set together.
+    std::vector<std::size_t> events( 2*m );
+    std::iota( events.begin(), events.end(), 0 );
+    auto eventPoint = [&]( std::size_t ev ) -> const Point& {
+      const Segment& s = segments[ev/2];
+      return ev%2 == 0 ? s.left : s.right;
+    };
+    std::sort( events.begin(), events.end(), [&]( std::size_t a, std::size_t b ){
+        const Point& pa = eventPoint( a );
+        const Point& pb = eventPoint( b );
+        if ( !( pa == pb ) ) return pa < pb;
+        return a%2 < b%2;
+      } );
+
+    typedef std::set<const Segment*,Below> Status;
+    Status status;
+    std::vector<Status::iterator> where( m );
+
+    auto check = [&]( Status::iterator a, Status::iterator b ) {
+      if ( !edgesIntersect( ring, (*a)->edge, (*b)->edge ) ) return false;
+      k = std::min( (*a)->edge, (*b)->edge );
+      l = std::max( (*a)->edge, (*b)->edge );
+      return true;
+    };
+
+    for ( const std::size_t ev : events ) {
+      const std::size_t e = ev/2;
+
+      if ( ev%2 == 0 ) {
+        const auto it = status.insert( &segments[e] ).first;
+        where[e] = it;
+        if ( std::next( it ) != status.end() && check( it, std::next( it ) ) ) return true;
+        if ( it != status.begin()            && check( std::prev( it ), it ) ) return true;
+      }
+      else {
+        const auto it = where[e];
+        if ( it != status.begin() && std::next( it ) != status.end() &&
+             check( std::prev( it ), std::next( it ) ) ) return true;
+        status.erase( it );
+      }
+    }
+
+    return false;
+  }
+
+}
+
+namespace util {
+
+  //=========================================================================
+  std::string PolygonProblem::describe() const {
+    switch ( kind ) {
+    case TooFewVertices   : return "fewer than 3 vertices";
+    case ZeroArea         : return "zero area";
+    case ZeroLengthEdge   : return "zero-length edge "+std::to_string( i );
+    case DuplicateVertex  : return "vertices "+std::to_string( i )+" and "+std::to_string( j )+" coincide";
+    case DuplicateEdge    : return "edges "+std::to_string( i )+" and "+std::to_string( j )+" are the same";
+    case SelfIntersection : return "edges "+std::to_string( i )+" and "+std::to_string( j )+" intersect";
+    }
+    return "unknown problem";
+  }
+
+  //=========================================================================
+  PolygonCheck checkPolygon( std::span<const double> x, std::span<const double> y ) {
+
+    PolygonCheck result;
+    const std::size_t n = std::min( x.size(), y.size() );
+
+    if ( n < 3 ) {
+      result.problems.push_back( { PolygonProblem::TooFewVertices } );
+      return result;
+    }
+
+    // Signed area (shoelace), and the extent for the zero-area tolerance
+    double twiceArea(0.);
+    double xMin = x[0], xMax = x[0], yMin = y[0], yMax = y[0];
+    for ( std::size_t i(0) ; i < n ; ++i ) {
+      const std::size_t j = (i+1)%n;
+      twiceArea += x[i]*y[j] - x[j]*y[i];
+      xMin = std::min( xMin, x[i] ); xMax = std::max( xMax, x[i] );
+      yMin = std::min( yMin, y[i] ); yMax = std::max( yMax, y[i] );
+    }
+    result.signedArea = 0.5*twiceArea;
+
+    // Drop repeated consecutive vertices, reporting the zero-length
+    // edges they make
+    Ring ring;
+    ring.points.reserve( n );
+    ring.origin.reserve( n );
+    for ( std::size_t i(0) ; i < n ; ++i ) {
+      const Point p{ x[i], y[i] };
+      if ( i > 0 && p == ring.points.back() ) {
+        result.problems.push_back( { PolygonProblem::ZeroLengthEdge, i-1 } );
+        continue;
+      }
+      ring.points.push_back( p );
+      ring.origin.push_back( i );
+    }
+    while ( ring.size() > 1 && ring.points.back() == ring.points.front() ) {
+      result.problems.push_back( { PolygonProblem::ZeroLengthEdge, n-1 } );
+      ring.points.pop_back();
+      ring.origin.pop_back();
+    }
+
+    const std::size_t m = ring.size();
+    if ( m < 3 ) {
+      result.problems.push_back( { PolygonProblem::TooFewVertices } );
+      return result;
+    }
+
+    const double extent = std::max( xMax-xMin, yMax-yMin );
+    if ( std::abs( result.signedArea ) <= 1e-12*extent*extent ) {
+      result.problems.push_back( { PolygonProblem::ZeroArea } );
+    }
+
+    // Vertices visited more than once
+    std::vector<std::size_t> order( m );
+    std::iota( order.begin(), order.end(), 0 );
+    std::sort( order.begin(), order.end(), [&]( std::size_t a, std::size_t b ){ return ring.vertex( a ) < ring.vertex( b ); } );
+    for ( std::size_t k(1) ; k < m ; ++k ) {
+      if ( !( ring.vertex( order[k] ) == ring.vertex( order[k-1] ) ) ) continue;
+      const std::size_t a = std::min( order[k], order[k-1] );
+      const std::size_t b = std::max( order[k], order[k-1] );
+      result.problems.push_back( { PolygonProblem::DuplicateVertex, ring.origin[a], ring.origin[b] } );
+    }
+
+    // Edges traversed more than once, in either direction
+    auto edgeEnds = [&]( std::size_t e ){
+      const Point& a = ring.vertex( e );
+      const Point& b = ring.next  ( e );
+      return ( a < b ) ? std::make_pair( a, b ) : std::make_pair( b, a );
+    };
+    std::iota( order.begin(), order.end(), 0 );
+    std::sort( order.begin(), order.end(), [&]( std::size_t a, std::size_t b ){ return edgeEnds( a ) < edgeEnds( b ); } );
+    for ( std::size_t k(1) ; k < m ; ++k ) {
+      if ( !( edgeEnds( order[k] ) == edgeEnds( order[k-1] ) ) ) continue;
+      const std::size_t a = std::min( order[k], order[k-1] );
+      const std::size_t b = std::max( order[k], order[k-1] );
+      result.problems.push_back( { PolygonProblem::DuplicateEdge, ring.origin[a], ring.origin[b] } );
+    }
+
+    std::size_t k(0), l(0);
+    if ( findIntersection( ring, k, l ) ) {
+      result.problems.push_back( { PolygonProblem::SelfIntersection, ring.origin[k], ring.origin[l] } );
+    }
+
+    return result;
+  }
+
+} // end of namespace util
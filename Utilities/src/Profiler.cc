@@ -0,0 +1,218 @@
+// Per-stage timing and counters.
+
+#include "Utilities/inc/Profiler.hh"
+#include "Utilities/inc/OutputFile.hh"
+#include "Utilities/inc/TextBuffer.hh"
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+  using StageCounters = util::Profiler::StageCounters;
+
+  const std::string globalVolume = "(global)";
+
+  // The counters of one thread; kept alive by the registry after the
+  // thread exits, so that writeJson() can merge them
+  struct ThreadRecord {
+    std::map<std::string,StageCounters> volumes;
+    StageCounters*                      current = nullptr;
+    util::Profiler::Scope*              active  = nullptr;
+  };
+
+  std::mutex                                 registryMutex;
+  std::vector<std::shared_ptr<ThreadRecord>> registry;
+  std::chrono::steady_clock::time_point      enabledAt;
+
+  ThreadRecord& threadRecord() {
+    thread_local std::shared_ptr<ThreadRecord> record;
+    if ( !record ) {
+      record = std::make_shared<ThreadRecord>();
+      record->current = &record->volumes[ globalVolume ];
+      std::lock_guard<std::mutex> lock( registryMutex );
+      registry.push_back( record );
+    }
+    return *record;
+  }
+
+  std::uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>
+      ( std::chrono::steady_clock::now().time_since_epoch() ).count();
+  }
+
+  void add( util::Profiler::Counters& sum, const util::Profiler::Counters& c ) {
+    sum.calls        += c.calls;
+    sum.wallNs       += c.wallNs;
+    sum.bytesRead    += c.bytesRead;
+    sum.bytesWritten += c.bytesWritten;
+    sum.allocations  += c.allocations;
+  }
+
+  void writeString( util::TextBuffer& os, const std::string& str ) {
+    static const char hex[] = "0123456789abcdef";
+    os << '"';
+    for ( const char c : str ) {
+      if      ( c == '"' || c == '\\' ) os << '\\' << c;
+      else if ( static_cast<unsigned char>( c ) < 0x20 ) os << "\\u00" << hex[ c >> 4 ] << hex[ c & 0xf ];
+      else os << c;
+    }
+    os << '"';
+  }
+
+  bool isEmpty( const StageCounters& stages ) {
+    for ( const auto& c : stages ) if ( c.calls != 0 ) return false;
+    return true;
+  }
+
+  void writeStages( util::TextBuffer& os, const StageCounters& stages, const char* indent ) {
+    os << '{';
+    bool first = true;
+    for ( int i(0) ; i < util::Profiler::nStages ; ++i ) {
+      const util::Profiler::Counters& c = stages[i];
+      if ( c.calls == 0 ) continue;
+      os << ( first ? "\n" : ",\n" ) << indent << "  ";
+      writeString( os, util::Profiler::stageName( util::Profiler::Stage( i ) ) );
+      os << ": { \"calls\": "         << c.calls
+         << ", \"wall_ns\": "         << c.wallNs
+         << ", \"bytes_read\": "      << c.bytesRead
+         << ", \"bytes_written\": "   << c.bytesWritten
+         << ", \"allocations\": "     << c.allocations << " }";
+      first = false;
+    }
+    if ( !first ) os << '\n' << indent;
+    os << '}';
+  }
+
+}
+
+namespace util {
+
+  std::atomic<bool> Profiler::enabled_( false );
+
+  thread_local std::size_t Profiler::allocations_( 0 );
+
+  //=========================================================================
+  const char* Profiler::stageName( Stage stage ) {
+    switch ( stage ) {
+    case Load          : return "load";
+    case Parse         : return "parse";
+    case Resolve       : return "resolve";
+    case Boundaries    : return "boundaries";
+    case DirtInference : return "dirtInference";
+    case Validate      : return "validate";
+    case Merge         : return "merge";
+    case Convex        : return "convex";
+    case Emit          : return "emit";
+    case TGeo          : return "tgeo";
+    default            : return "unknown";
+    }
+  }
+
+  //=========================================================================
+  void Profiler::enable() {
+    enabledAt = std::chrono::steady_clock::now();
+    enabled_.store( true, std::memory_order_relaxed );
+  }
+
+  //=========================================================================
+  void Profiler::addBytes( std::size_t read, std::size_t written ) {
+    Scope* active = threadRecord().active;
+    if ( active == nullptr ) return;
+    active->counters_->bytesRead    += read;
+    active->counters_->bytesWritten += written;
+  }
+
+  //=========================================================================
+  void Profiler::Scope::begin( Stage stage ) {
+    ThreadRecord& record = threadRecord();
+    counters_         = &(*record.current)[stage];
+    parent_           = record.active;
+    childNs_          = 0;
+    childAllocations_ = 0;
+    record.active     = this;
+    startAllocations_ = allocations_;
+    startNs_          = nowNs();
+  }
+
+  //=========================================================================
+  void Profiler::Scope::end() {
+    const std::uint64_t elapsed = nowNs()-startNs_;
+    const std::size_t   allocs  = allocations_-startAllocations_;
+
+    counters_->calls       += 1;
+    counters_->wallNs      += elapsed-childNs_;
+    counters_->allocations += allocs-childAllocations_;
+
+    if ( parent_ != nullptr ) {
+      parent_->childNs_          += elapsed;
+      parent_->childAllocations_ += allocs;
+    }
+    threadRecord().active = parent_;
+  }
+
+  //=========================================================================
+  void Profiler::Volume::begin( const std::string& name ) {
+    ThreadRecord& record = threadRecord();
+    previous_ = record.current;
+    record.current = &record.volumes[ name ];
+  }
+
+  //=========================================================================
+  void Profiler::Volume::end() {
+    threadRecord().current = previous_;
+  }
+
+  //=========================================================================
+  void Profiler::writeJson( const std::string& filename ) {
+
+    const std::chrono::duration<double,std::nano> wall = std::chrono::steady_clock::now()-enabledAt;
+
+    // Merge the threads
+    std::map<std::string,StageCounters> volumes;
+    std::size_t nThreads(0);
+    {
+      std::lock_guard<std::mutex> lock( registryMutex );
+      nThreads = registry.size();
+      for ( const auto& record : registry ) {
+        for ( const auto& volume : record->volumes ) {
+          StageCounters& sum = volumes[ volume.first ];
+          for ( int i(0) ; i < nStages ; ++i ) add( sum[i], volume.second[i] );
+        }
+      }
+    }
+
+    StageCounters total;
+    for ( const auto& volume : volumes ) {
+      for ( int i(0) ; i < nStages ; ++i ) add( total[i], volume.second[i] );
+    }
+
+    TextBuffer os;
+    os << "{\n";
+    os << "  \"wall_ns\": " << static_cast<std::size_t>( wall.count() ) << ",\n";
+    os << "  \"threads\": " << nThreads << ",\n";
+    os << "  \"total\": ";
+    writeStages( os, total, "  " );
+    os << ",\n";
+    os << "  \"volumes\": {";
+    bool first = true;
+    for ( const auto& volume : volumes ) {
+      if ( isEmpty( volume.second ) ) continue;
+      os << ( first ? "\n" : ",\n" ) << "    ";
+      writeString( os, volume.first );
+      os << ": ";
+      writeStages( os, volume.second, "    " );
+      first = false;
+    }
+    if ( !first ) os << "\n  ";
+    os << "}\n";
+    os << "}\n";
+
+    writeAtomically( filename, os.view() );
+  }
+
+} // end of namespace util
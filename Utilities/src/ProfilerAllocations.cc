@@ -0,0 +1,24 @@
+// Counting replacement of the global operator new, for the allocation
+// counters of the Profiler.  Kept out of libUtilitiesCore.a so that
+// only the programs that link this object replace the allocator.
+
+#include "Utilities/inc/Profiler.hh"
+
+#include <cstdlib>
+#include <new>
+
+#ifndef UTIL_NO_PROFILING
+
+// The array, nothrow and sized forms of the standard library all end
+// up here
+void* operator new( std::size_t size ) {
+  util::Profiler::countAllocation();
+  for (;;) {
+    if ( void* p = std::malloc( size != 0 ? size : 1 ) ) return p;
+    std::new_handler handler = std::get_new_handler();
+    if ( handler == nullptr ) throw std::bad_alloc();
+    handler();
+  }
+}
+
+#endif
@@ -0,0 +1,94 @@
+// SimpleConfig files of volumes given as values.
+
+#include "Utilities/inc/SimpleConfigWriter.hh"
+#include "Utilities/inc/OutputFile.hh"
+#include "Utilities/inc/Profiler.hh"
+#include "Utilities/inc/TextBuffer.hh"
+
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+  void replacementList( util::TextBuffer& os, const std::string& varprefix, const std::vector<std::size_t>& v ) {
+    if ( v.empty() ) return;
+    os << "vector<int>    " << varprefix << "replace   = { ";
+    for ( std::size_t j(0) ; j < v.size() ; ++j ) {
+      os << v[j];
+      os << ( j+1 != v.size() ? ", " : " }; \n" );
+    }
+  }
+
+  void positionList( util::TextBuffer& os, const std::string& varprefix, const std::vector<double>& positions,
+                     const util::VertexSuffix& suffix ) {
+    os << "vector<double> " << varprefix << "Positions = {\n";
+    for ( std::size_t j(0) ; j < positions.size() ; ++j ) {
+      os << "  " << positions[j];
+      if      ( suffix                 ) suffix( os, j );
+      else if ( j+1 != positions.size() ) os << ',';
+      os << '\n';
+    }
+    os << "};\n";
+  }
+
+}
+
+namespace util {
+
+  //=========================================================================
+  void addSimpleConfigFile( Config& config, const SimpleConfigVolume& volume, const std::string& dir ) {
+    const bool dirt = volume.prefix.find("dirt.") != std::string::npos;
+    ( dirt ? config.dirtFiles    : config.bldgFiles    ).push_back( "#include \"Mu2eG4/geom/bldg/"+volume.name+".txt\"" );
+    ( dirt ? config.dirtPrefixes : config.bldgPrefixes ).push_back( volume.prefix );
+    config.outputFiles.push_back( dir+volume.name+".txt" );
+  }
+
+  //=========================================================================
+  void formatSimpleConfigFile( TextBuffer& fs, const SimpleConfigVolume& volume, std::string_view comment,
+                               const VertexSuffix& suffix ) {
+
+    const std::string& varprefix = volume.prefix;
+
+    fs << comment;
+    fs << '\n';
+    fs << "string " << varprefix << ".name     = \"" << volume.name << "\";\n";
+    fs << '\n';
+    fs << "string " << varprefix << ".material = \"" << volume.material << "\";\n";
+    fs << '\n';
+    fs << "double " << varprefix << ".offsetFromMu2eOrigin.x   = " << volume.offsetFromMu2eOriginX   << ";\n";
+    fs << "double " << varprefix << ".offsetFromFloorSurface.y = " << volume.offsetFromFloorSurfaceY << ";\n";
+    fs << "double " << varprefix << ".offsetFromMu2eOrigin.z   = " << volume.offsetFromMu2eOriginZ   << ";\n";
+    fs << '\n';
+    fs << "double " << varprefix << ".yHalfThickness           = " << volume.yHalfThickness << ";\n";
+    fs << '\n';
+
+    replacementList( fs, varprefix+".x", volume.xReplace );
+    positionList   ( fs, varprefix+".x", volume.x, suffix );
+
+    fs << '\n';
+
+    replacementList( fs, varprefix+".y", volume.yReplace );
+    positionList   ( fs, varprefix+".y", volume.y, suffix );
+
+    fs << '\n';
+    fs << "// Local Variables:\n";
+    fs << "// mode:c++\n";
+    fs << "// End:\n";
+  }
+
+  //=========================================================================
+  void printSimpleConfigFile( const SimpleConfigVolume& volume, std::string_view comment,
+                              Config& config, const std::string& dir ) {
+
+    UTIL_PROFILE_SCOPE( Emit );
+
+    addSimpleConfigFile( config, volume, dir );
+
+    thread_local TextBuffer fs;
+    fs.clear();
+    formatSimpleConfigFile( fs, volume, comment );
+
+    writeIfChanged( dir+volume.name+".txt", fs.view() );
+  }
+
+} // end of namespace util
@@ -0,0 +1,293 @@
+// Batch classification of points into the volumes of the hall.
+
+#include "Utilities/inc/VolumeLocator.hh"
+#include "Utilities/inc/BinaryGeometry.hh"
+#include "Utilities/inc/BoundingVolumeHierarchy.hh"
+#include "Utilities/inc/parallelFor.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+  // Points handed to a thread at a time
+  constexpr std::size_t chunkSize = 4096;
+
+  // Size of the candidate grid
+  constexpr double cellsPerVolume = 64;
+  constexpr double maxLayers      = 16;
+  constexpr double maxCells       = 1 << 22;
+  constexpr double maxEntries     = 1 << 22;
+
+  // Edges tested at once: the doubles in a vector register of the
+  // target (SSE2 by default, AVX with e.g. -march=native)
+#ifdef __AVX__
+  constexpr std::size_t width = 4;
+#else
+  constexpr std::size_t width = 2;
+#endif
+
+  typedef double       Lanes __attribute__(( vector_size( width*sizeof(double) ) ));
+  typedef std::int64_t Masks __attribute__(( vector_size( width*sizeof(double) ) ));
+
+  inline Lanes load( const double* p ) {
+    Lanes v;
+    std::memcpy( &v, p, sizeof(v) );
+    return v;
+  }
+
+}
+
+namespace util {
+
+  // A volume's extent and polygon (Mu2e x/z), with its id
+  struct VolumeLocator::Box {
+    std::uint32_t                   volume;
+    BoundingVolumeHierarchy::Box    extent;
+    std::vector<double>             x;
+    std::vector<double>             z;
+  };
+
+  //=========================================================================
+  VolumeLocator::VolumeLocator( std::span<const SimpleConfigVolume> volumes ) {
+    std::vector<Box> boxes;
+    for ( const auto& v : volumes ) {
+      add( v.x, v.y, v.yMin, v.yMax, v.offsetFromMu2eOriginX, v.offsetFromMu2eOriginZ, boxes );
+    }
+    buildGrid( boxes );
+  }
+
+  //=========================================================================
+  VolumeLocator::VolumeLocator( const BinaryGeometry& geometry ) {
+    std::vector<Box> boxes;
+    for ( std::size_t i(0) ; i < geometry.size() ; ++i ) {
+      const BinaryGeometry::Volume v = geometry[i];
+      add( v.x, v.y, v.yMin, v.yMax, v.offsetFromMu2eOriginX, v.offsetFromMu2eOriginZ, boxes );
+    }
+    buildGrid( boxes );
+  }
+
+  //=========================================================================
+  void VolumeLocator::add( std::span<const double> x, std::span<const double> y,
+                           const double yMin, const double yMax,
+                           const double offsetX, const double offsetZ,
+                           std::vector<Box>& boxes ) {
+
+    if ( z0_.size() > std::numeric_limits<std::uint32_t>::max()/2 || slabs_.size() >= interior )
+      throw std::runtime_error( "Too many volumes or edges for a VolumeLocator" );
+
+    Slab slab{ yMin, yMax, static_cast<std::uint32_t>( z0_.size() ), 0 };
+
+    // Volumes without a polygon contain nothing and get no box
+    const std::size_t n = x.size();
+    if ( n < 3 || y.size() != n ) {
+      slabs_.push_back( slab );
+      return;
+    }
+
+    // Polygon x/y are Mu2e z/x
+    Box box{ static_cast<std::uint32_t>( slabs_.size() ), {}, {}, {} };
+    box.extent.min = { std::numeric_limits<double>::max(), yMin, std::numeric_limits<double>::max() };
+    box.extent.max = { std::numeric_limits<double>::lowest(), yMax, std::numeric_limits<double>::lowest() };
+
+    for ( std::size_t i(0) ; i < n ; ++i ) {
+      const std::size_t j = (i+1)%n;
+
+      // Each edge is stored from its lower-x end, so that an edge shared
+      // by two volumes gives the same crossing in both
+      double za = x[i]+offsetZ, xa = y[i]+offsetX;
+      double zb = x[j]+offsetZ, xb = y[j]+offsetX;
+      if ( xb < xa ) { std::swap( za, zb ); std::swap( xa, xb ); }
+
+      z0_  .push_back( za );
+      x0_  .push_back( xa );
+      x1_  .push_back( xb );
+      dzdx_.push_back( xb != xa ? (zb-za)/(xb-xa) : 0. );
+
+      box.extent.min[0] = std::min( box.extent.min[0], xa ); box.extent.max[0] = std::max( box.extent.max[0], xb );
+      box.extent.min[2] = std::min( box.extent.min[2], std::min( za, zb ) );
+      box.extent.max[2] = std::max( box.extent.max[2], std::max( za, zb ) );
+      box.x.push_back( y[i]+offsetX );
+      box.z.push_back( x[i]+offsetZ );
+    }
+
+    // Padding edges lie above every point and are never crossed
+    while ( ( z0_.size()-slab.firstEdge ) % lanes != 0 ) {
+      z0_  .push_back( 0. );
+      x0_  .push_back( std::numeric_limits<double>::max() );
+      x1_  .push_back( std::numeric_limits<double>::max() );
+      dzdx_.push_back( 0. );
+    }
+
+    slab.nEdges = z0_.size()-slab.firstEdge;
+    boxes.push_back( std::move( box ) );
+    slabs_.push_back( slab );
+  }
+
+  //=========================================================================
+  void VolumeLocator::buildGrid( const std::vector<Box>& boxes ) {
+
+    if ( boxes.empty() ) return;
+
+    std::array<double,3> gridMax;
+    gridMin_.fill( std::numeric_limits<double>::max() );
+    gridMax .fill( std::numeric_limits<double>::lowest() );
+    for ( const auto& b : boxes ) {
+      for ( std::size_t a(0) ; a < 3 ; ++a ) {
+        gridMin_[a] = std::min( gridMin_[a], b.extent.min[a] );
+        gridMax [a] = std::max( gridMax [a], b.extent.max[a] );
+      }
+    }
+
+    // About cellsPerVolume square cells in x-z per volume, and cubic
+    // cells in y up to maxLayers; coarser if the boxes would be listed in
+    // more than maxEntries cells in total (large overlapping volumes)
+    std::array<double,3> extent;
+    for ( std::size_t a(0) ; a < 3 ; ++a ) extent[a] = std::max( gridMax[a]-gridMin_[a], std::numeric_limits<double>::min() );
+    const double cells = std::min( cellsPerVolume*boxes.size(), maxCells/maxLayers );
+    const std::array<double,3> maxSize{ cells, maxLayers, cells };
+    for ( double side = std::sqrt( extent[0]*extent[2]/cells ) ; ; side *= std::sqrt( 2. ) ) {
+      for ( std::size_t a(0) ; a < 3 ; ++a ) {
+        gridSize_ [a] = std::clamp<double>( std::ceil( extent[a]/side ), 1., maxSize[a] );
+        gridScale_[a] = gridSize_[a]/extent[a];
+      }
+
+      double entries(0.);
+      for ( const auto& b : boxes ) {
+        double spanned(1.);
+        for ( std::size_t a(0) ; a < 3 ; ++a ) {
+          spanned *= std::floor( ( b.extent.max[a]-gridMin_[a] )*gridScale_[a] )
+                   - std::floor( ( b.extent.min[a]-gridMin_[a] )*gridScale_[a] ) + 1.;
+        }
+        entries += spanned;
+      }
+      if ( entries <= maxEntries || gridSize_ == std::array<std::size_t,3>{ 1, 1, 1 } ) break;
+    }
+
+    // Volumes of each cell, from a query with the cell widened a little
+    // so that rounding in locate() cannot miss one.  Volumes whose
+    // footprint covers the cell are marked interior, those that miss it
+    // are dropped.
+    std::vector<BoundingVolumeHierarchy::Box> extents;
+    for ( const auto& b : boxes ) extents.push_back( b.extent );
+    const BoundingVolumeHierarchy bvh( std::move( extents ) );
+
+    const double margin = 1e-9;
+    std::vector<std::uint32_t> volumes;
+    cellStart_.assign( 1, 0 );
+    std::array<std::size_t,3> index;
+    for ( index[0] = 0 ; index[0] < gridSize_[0] ; ++index[0] ) {
+      for ( index[1] = 0 ; index[1] < gridSize_[1] ; ++index[1] ) {
+        for ( index[2] = 0 ; index[2] < gridSize_[2] ; ++index[2] ) {
+          BoundingVolumeHierarchy::Box cell;
+          for ( std::size_t a(0) ; a < 3 ; ++a ) {
+            cell.min[a] = gridMin_[a]+( index[a]  -margin )/gridScale_[a];
+            cell.max[a] = gridMin_[a]+( index[a]+1+margin )/gridScale_[a];
+          }
+
+          volumes.clear();
+          bvh.query( cell, [&]( std::size_t b ){ volumes.push_back( b ); } );
+          std::sort( volumes.begin(), volumes.end() );
+          for ( const std::uint32_t b : volumes ) {
+            const Box& box = boxes[b];
+            if ( crossesCell( box, cell ) ) cellVolumes_.push_back( box.volume );
+            else if ( inFootprint( slabs_[box.volume], 0.5*( cell.min[0]+cell.max[0] ), 0.5*( cell.min[2]+cell.max[2] ) ) )
+              cellVolumes_.push_back( box.volume | interior );
+          }
+          cellStart_.push_back( cellVolumes_.size() );
+        }
+      }
+    }
+  }
+
+  //=========================================================================
+  bool VolumeLocator::crossesCell( const Box& box, const BoundingVolumeHierarchy::Box& cell ) {
+
+    // Separating axes: those of the cell, then the normal of the edge
+    const std::size_t n = box.x.size();
+    for ( std::size_t i(0) ; i < n ; ++i ) {
+      const double xa = box.x[i], za = box.z[i];
+      const double xb = box.x[(i+1)%n], zb = box.z[(i+1)%n];
+      if ( std::max( xa, xb ) < cell.min[0] || std::min( xa, xb ) > cell.max[0] ||
+           std::max( za, zb ) < cell.min[2] || std::min( za, zb ) > cell.max[2] ) continue;
+
+      bool above(false), below(false);
+      for ( const double cx : { cell.min[0], cell.max[0] } ) {
+        for ( const double cz : { cell.min[2], cell.max[2] } ) {
+          const double side = ( xb-xa )*( cz-za ) - ( zb-za )*( cx-xa );
+          above |= side >= 0;
+          below |= side <= 0;
+        }
+      }
+      if ( above && below ) return true;
+    }
+    return false;
+  }
+
+  //=========================================================================
+  bool VolumeLocator::inFootprint( const Slab& slab, const double px, const double pz ) const {
+
+    const double* z0   = z0_  .data()+slab.firstEdge;
+    const double* x0   = x0_  .data()+slab.firstEdge;
+    const double* x1   = x1_  .data()+slab.firstEdge;
+    const double* dzdx = dzdx_.data()+slab.firstEdge;
+
+    // Crossings of the ray from the point along +z; comparisons give -1
+    // in the lanes where they hold
+    static_assert( lanes % width == 0 );
+    Masks crossings = {};
+    for ( std::uint32_t b(0) ; b < slab.nEdges ; b += width ) {
+      const Lanes start  = load( x0+b );
+      const Masks spans  = ( start <= px ) ^ ( load( x1+b ) <= px );
+      const Masks before = pz < load( z0+b ) + ( px-start )*load( dzdx+b );
+      crossings -= spans & before;
+    }
+
+    std::int64_t total(0);
+    for ( std::size_t k(0) ; k < width ; ++k ) total += crossings[k];
+    return total & 1;
+  }
+
+  //=========================================================================
+  std::uint32_t VolumeLocator::locate( const Point& point ) const {
+
+    std::size_t c(0);
+    for ( std::size_t a(0) ; a < 3 ; ++a ) {
+      const double i = ( point[a]-gridMin_[a] )*gridScale_[a];
+      if ( !( i >= 0 && i < gridSize_[a] ) ) return outside;   // also NaN
+      c = c*gridSize_[a] + static_cast<std::size_t>( i );
+    }
+
+    // The candidates are in increasing order, so the first one wins
+    for ( std::uint32_t j = cellStart_[c] ; j < cellStart_[c+1] ; ++j ) {
+      const std::uint32_t v    = cellVolumes_[j] & ~interior;
+      const Slab&         slab = slabs_[v];
+      if ( !( slab.yMin <= point[1] && point[1] < slab.yMax ) ) continue;
+      if ( ( cellVolumes_[j] & interior ) || inFootprint( slab, point[0], point[2] ) ) return v;
+    }
+    return outside;
+  }
+
+  //=========================================================================
+  void VolumeLocator::classify( std::span<const Point> points, std::span<std::uint32_t> ids, const unsigned nThreads ) const {
+
+    if ( ids.size() != points.size() )
+      throw std::runtime_error( "VolumeLocator::classify: points and ids differ in size" );
+
+    const std::size_t nChunks = ( points.size()+chunkSize-1 )/chunkSize;
+    parallelFor( nChunks, nThreads, [&]( std::size_t c ){
+        const std::size_t end = std::min( points.size(), (c+1)*chunkSize );
+        for ( std::size_t i = c*chunkSize ; i < end ; ++i ) ids[i] = locate( points[i] );
+      } );
+  }
+
+  //=========================================================================
+  std::vector<std::uint32_t> VolumeLocator::classify( std::span<const Point> points, const unsigned nThreads ) const {
+    std::vector<std::uint32_t> ids( points.size() );
+    classify( points, ids, nThreads );
+    return ids;
+  }
+
+} // end of namespace util
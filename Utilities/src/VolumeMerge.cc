@@ -0,0 +1,161 @@
+// Merging of volumes that share boundary edges.
+
+#include "Utilities/inc/VolumeMerge.hh"
+#include "Utilities/inc/PolygonBoolean.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <map>
+#include <numeric>
+#include <set>
+#include <string>
+#include <tuple>
+
+namespace {
+
+  bool isDirt( const util::SimpleConfigVolume& volume ) {
+    return volume.prefix.find("dirt.") != std::string::npos;
+  }
+
+  // Whether an edge of a and an edge of b are collinear and overlap
+  bool shareEdge( const util::SimpleConfigVolume& a, const util::SimpleConfigVolume& b, double tolerance ) {
+
+    const auto [aMinX, aMaxX] = std::minmax_element( a.x.begin(), a.x.end() );
+    const auto [aMinY, aMaxY] = std::minmax_element( a.y.begin(), a.y.end() );
+    const auto [bMinX, bMaxX] = std::minmax_element( b.x.begin(), b.x.end() );
+    const auto [bMinY, bMaxY] = std::minmax_element( b.y.begin(), b.y.end() );
+    if ( *aMinX > *bMaxX+tolerance || *bMinX > *aMaxX+tolerance ||
+         *aMinY > *bMaxY+tolerance || *bMinY > *aMaxY+tolerance ) return false;
+
+    const std::size_t n = a.x.size(), m = b.x.size();
+    for ( std::size_t i(0) ; i < n ; ++i ) {
+      const double px = a.x[i], py = a.y[i];
+      const double dx = a.x[(i+1)%n]-px, dy = a.y[(i+1)%n]-py;
+      const double length = std::hypot( dx, dy );
+      if ( length <= tolerance ) continue;
+      const double ux = dx/length, uy = dy/length;
+
+      for ( std::size_t j(0) ; j < m ; ++j ) {
+        const double rx = b.x[j]-px,       ry = b.y[j]-py;
+        const double sx = b.x[(j+1)%m]-px, sy = b.y[(j+1)%m]-py;
+        if ( std::abs( ux*ry - uy*rx ) > tolerance || std::abs( ux*sy - uy*sx ) > tolerance ) continue;
+        const double tr = ux*rx + uy*ry, ts = ux*sx + uy*sy;
+        const double overlap = std::min( length, std::max( tr, ts ) ) - std::max( 0., std::min( tr, ts ) );
+        if ( overlap > tolerance ) return true;
+      }
+    }
+    return false;
+  }
+
+  // "building.dsArea.upper" -> "dsAreaUpper", as the names of the
+  // volumes of the .ccl files
+  std::string nameOf( const std::string& prefix ) {
+    const std::string volName = prefix.rfind( "building.", 0 ) == 0 ? prefix.substr( 9 ) : prefix;
+    std::string name;
+    bool capitalize = false;
+    for ( char c : volName ) {
+      if ( c == '.' ) { capitalize = !name.empty(); continue; }
+      name += capitalize ? std::toupper( c ) : c;
+      capitalize = false;
+    }
+    return name;
+  }
+
+  // The dotted tokens all prefixes start with
+  std::string commonPrefix( const std::vector<std::string>& prefixes ) {
+    std::string common = prefixes.front();
+    for ( const auto& prefix : prefixes ) {
+      std::size_t k(0);
+      while ( k < common.size() && k < prefix.size() && common[k] == prefix[k] ) ++k;
+      const bool wholeToken = ( k == common.size() || common[k] == '.' ) && ( k == prefix.size() || prefix[k] == '.' );
+      if ( !wholeToken ) {
+        const std::size_t dot = common.rfind( '.', k );
+        k = dot == std::string::npos ? 0 : dot;
+      }
+      common.resize( k );
+    }
+    return common;
+  }
+
+  std::size_t findRoot( std::vector<std::size_t>& parent, std::size_t i ) {
+    while ( parent[i] != i ) i = parent[i] = parent[parent[i]];
+    return i;
+  }
+
+}
+
+namespace util {
+
+  //=========================================================================
+  std::vector<VolumeMerge> mergeVolumes( std::span<const SimpleConfigVolume> volumes,
+                                         double worldX, double worldY,
+                                         double tolerance ) {
+
+    typedef std::tuple<bool,double,double,std::string,double,double> Key;
+    std::map<Key,std::vector<std::size_t>> groups;
+    for ( std::size_t i(0) ; i < volumes.size() ; ++i ) {
+      const auto& v = volumes[i];
+      if ( v.x.size() < 3 ) continue;
+      groups[ Key( isDirt( v ), v.yMin, v.yMax, v.material, v.offsetFromMu2eOriginX, v.offsetFromMu2eOriginZ ) ].push_back( i );
+    }
+
+    std::set<std::string> taken;
+    for ( const auto& v : volumes ) taken.insert( v.prefix );
+
+    std::vector<std::size_t> parent( volumes.size() );
+    std::iota( parent.begin(), parent.end(), 0 );
+
+    std::vector<VolumeMerge> merges;
+    for ( const auto& group : groups ) {
+      const std::vector<std::size_t>& members = group.second;
+      for ( std::size_t a(0) ; a < members.size() ; ++a ) {
+        for ( std::size_t b(a+1) ; b < members.size() ; ++b ) {
+          if ( !shareEdge( volumes[members[a]], volumes[members[b]], tolerance ) ) continue;
+          parent[ findRoot( parent, members[b] ) ] = findRoot( parent, members[a] );
+        }
+      }
+
+      std::map<std::size_t,std::vector<std::size_t>> components;
+      for ( std::size_t i : members ) components[ findRoot( parent, i ) ].push_back( i );
+
+      for ( const auto& component : components ) {
+        const std::vector<std::size_t>& indices = component.second;
+        if ( indices.size() < 2 ) continue;
+
+        std::vector<Polygon> polygons;
+        std::vector<std::string> prefixes;
+        for ( std::size_t i : indices ) {
+          polygons.push_back( { volumes[i].x, volumes[i].y } );
+          prefixes.push_back( volumes[i].prefix );
+        }
+        std::vector<Polygon> pieces = polygonDifference( polygons, {}, tolerance );
+        if ( pieces.empty() || pieces.size() >= indices.size() ) continue;
+
+        VolumeMerge merge;
+        merge.members = indices;
+
+        const SimpleConfigVolume& first = volumes[indices.front()];
+        const std::string common = commonPrefix( prefixes );
+        for ( std::size_t p(0) ; p < pieces.size() ; ++p ) {
+          std::string base = ( common.find('.') == std::string::npos ? first.prefix : common )+".merged";
+          if ( pieces.size() > 1 ) base += std::to_string( p+1 );
+          std::string prefix = base;
+          for ( int k(2) ; taken.count( prefix ) ; ++k ) prefix = base+"."+std::to_string( k );
+          taken.insert( prefix );
+
+          SimpleConfigVolume volume = first;
+          volume.prefix = prefix;
+          volume.name   = nameOf( prefix );
+          volume.x      = std::move( pieces[p].x );
+          volume.y      = std::move( pieces[p].y );
+          setWorldReplace( volume, worldX, worldY );
+          merge.volumes.push_back( std::move( volume ) );
+        }
+        merges.push_back( std::move( merge ) );
+      }
+    }
+    return merges;
+  }
+
+} // end of namespace util
@@ -10,7 +10,11 @@ export PATH=${PWD}:$PATH
 # make directories if they doesn't exist
 mkdir -p Run/bin/
 mkdir -p Run/obj/
+mkdir -p Run/lib/
 mkdir -p Utilities/obj/
+mkdir -p Utilities/lib/
+mkdir -p Bench/bin/
+mkdir -p Bench/obj/
 mkdir -p output
 
 export PATH=Run/bin/:$PATH